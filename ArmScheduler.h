@@ -0,0 +1,269 @@
+//------------------------------------------------------------------------------
+// ArmScheduler class - drives several arms from one board. Each arm is an
+// ArmStation, with its own planner, executor, parser and serial port, so it
+// takes its own job and answers its own realtime commands. None of them
+// blocks, so the scheduler simply services every station in turn on each
+// pass of loop(), and each executor catches up on the ticks which passed
+// while the others ran.
+//
+// The time spent on each station is counted, and given with the distance it
+// drew in its status reports, so it shows how many arms the board can keep
+// up with. While the board keeps up the pass takes under a tick and the CPU
+// shares add up to well under 100%.
+//------------------------------------------------------------------------------
+// Copyright at end of file.
+
+#ifndef ArmScheduler_H
+#define ArmScheduler_H
+
+#include "StatusReport.h"
+
+// Most arms one scheduler drives.
+#ifndef MAX_ARMS
+#define MAX_ARMS 4
+#endif
+
+class ArmStation
+{
+public:
+  /**
+   * Constructor used to bind the station to its arm and serial port. The
+   * feed, acceleration and junction deviation are replaced by the settings.
+   * @param arm - the robot which is positioned at each step.
+   * @param rx - receive buffer of the port the arm's commands arrive on.
+   */
+  ArmStation(GCodeProcessor *arm, RxBuffer *rx)
+    : planner(arm, 3000, 500, 0.05), parser(&planner, rx), executor(&planner, arm)
+  {
+    _arm = arm;
+    _rx = rx;
+    _shared = false;
+  }
+
+  // The parser queues blocks in the planner, which feeds them to the arm.
+  Planner planner;
+  Parser<Planner> parser;
+
+  // Steps the arm through the planned blocks.
+  Executor executor;
+
+  // Work done for the arm since its last status report.
+  ArmLoad load;
+
+  /**
+   * Marks the station as one of several on the board, whose status reports
+   * carry its number and load.
+   */
+  void share(byte index)
+  {
+    _shared = true;
+    load.index = index;
+    load.reset(&executor);
+  }
+
+  /**
+   * Parks the arm and starts its clock, after the banner has been sent.
+   * Every station sets up the same timer, so starting it again is harmless.
+   */
+  void begin()
+  {
+    parser.reset();
+    _arm->park();
+    planner.clear();
+    executor.begin();
+  }
+
+  /**
+   * The parser queues any available input, then the executor advances the
+   * motion by the ticks which have elapsed. Neither blocks, so realtime
+   * commands are acted upon within one pass.
+   */
+  void run()
+  {
+    unsigned long start = micros();
+    parser.listen();
+    executor.run();
+    realtimeCommands();
+    load.busyMicros += micros() - start;
+  }
+
+  /**
+   * Stops at once and forgets everything queued, leaving the arm where it
+   * is with the pen raised. The servos hold their last position, so it is
+   * still known.
+   */
+  void softReset()
+  {
+    // Lift the pen first, so the executor and planner adopt its height.
+    _arm->enableVacuum(false);
+    executor.reset();
+    planner.clear();
+    _rx->clear();
+#ifdef JOB_STORAGE
+    if (_rx == &serialRx)
+    {
+      jobs.stop();
+    }
+#endif
+    parser.abort();
+    parser.reportMessage(STATUS_VERSION);
+  }
+
+private:
+  GCodeProcessor * _arm;
+  RxBuffer * _rx;
+  boolean _shared;
+
+  /**
+   * Acts upon the realtime commands received since the last pass.
+   */
+  void realtimeCommands()
+  {
+    unsigned int commands = _rx->takeRealtime();
+    if (commands & RT_RESET)
+    {
+      softReset();
+    }
+    else
+    {
+      if (commands & RT_CYCLE_START)
+      {
+        executor.cycleStart();
+      }
+      if (commands & RT_FEED_HOLD)
+      {
+        executor.feedHold();
+      }
+
+      int feed = executor.getFeedOverride();
+      if (commands & RT_FEED_OVR_RESET)
+      {
+        feed = 100;
+      }
+      if (commands & RT_FEED_OVR_COARSE_PLUS)
+      {
+        feed += FEED_OVERRIDE_COARSE;
+      }
+      if (commands & RT_FEED_OVR_COARSE_MINUS)
+      {
+        feed -= FEED_OVERRIDE_COARSE;
+      }
+      if (commands & RT_FEED_OVR_FINE_PLUS)
+      {
+        feed += FEED_OVERRIDE_FINE;
+      }
+      if (commands & RT_FEED_OVR_FINE_MINUS)
+      {
+        feed -= FEED_OVERRIDE_FINE;
+      }
+      executor.setFeedOverride(feed);
+    }
+
+    if (commands & RT_STATUS_REPORT)
+    {
+      reportStatus(_arm, &planner, &executor, _rx, _shared ? &load : NULL);
+    }
+  }
+};
+
+class ArmScheduler
+{
+public:
+  ArmScheduler()
+  {
+    _count = 0;
+  }
+
+  /**
+   * Adds a station to be serviced, numbering it in the order added.
+   * @return false if MAX_ARMS are already driven.
+   */
+  boolean add(ArmStation *station)
+  {
+    if (_count >= MAX_ARMS)
+    {
+      return false;
+    }
+    _stations[_count++] = station;
+    return true;
+  }
+
+  byte count()
+  {
+    return _count;
+  }
+
+  ArmStation *station(byte index)
+  {
+    return _stations[index];
+  }
+
+  /**
+   * Parks every arm and starts its clock. A lone arm reports its status as
+   * before, several also report their load.
+   */
+  void begin()
+  {
+    for (byte i = 0; i < _count; i++)
+    {
+      _stations[i]->begin();
+      if (_count > 1)
+      {
+        _stations[i]->share(i);
+      }
+    }
+  }
+
+  /**
+   * Services each station once. Called from loop().
+   */
+  void run()
+  {
+    for (byte i = 0; i < _count; i++)
+    {
+      _stations[i]->run();
+    }
+  }
+
+  /**
+   * Returns true once every arm has stopped with nothing queued.
+   */
+  boolean idle()
+  {
+    for (byte i = 0; i < _count; i++)
+    {
+      if (!_stations[i]->planner.idle() || !_stations[i]->executor.isIdle())
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+private:
+  ArmStation * _stations[MAX_ARMS];
+  byte _count;
+};
+
+#endif  // ArmScheduler_H
+
+//------------------------------------------------------------------------------
+// Copyright (C) 2015 Martin Heermance (mheermance@gmail.com)
+/*
+┌──────────────────────────────────────────────────────────────────────────┐
+│                                                   TERMS OF USE: MIT License                                                   │
+├──────────────────────────────────────────────────────────────────────────┤
+│Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation     │
+│files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,     │
+│modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software │
+│is furnished to do so, subject to the following conditions:                                                                    │
+│                                                                                                                               │
+│The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. │
+│                                                                                                                               │
+│THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE           │
+│WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR          │
+│COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,    │
+│ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                          │
+└──────────────────────────────────────────────────────────────────────────┘
+*/
+
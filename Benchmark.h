@@ -0,0 +1,244 @@
+//------------------------------------------------------------------------------
+// Benchmarks of the parser, inverse kinematics and interpolation hot paths,
+// run instead of normal operation when BENCHMARK is defined in the sketch.
+// Results are printed on the serial port as one line of JSON. On the ATmega
+// times are in clock cycles, derived from micros() over many iterations,
+// and on a host build they are in nanoseconds.
+//------------------------------------------------------------------------------
+// Copyright at end of file.
+
+#ifndef Benchmark_H
+#define Benchmark_H
+
+#include "ScaraArm.h"
+#include "Executor.h"
+
+#ifdef __AVR__
+#define BENCH_UNIT "cycles"
+#define BENCH_UNITS_PER_TICK clockCyclesPerMicrosecond()
+
+inline unsigned long benchClock()
+{
+  return micros();
+}
+#else
+#include <time.h>
+
+#define BENCH_UNIT "ns"
+#define BENCH_UNITS_PER_TICK 1
+
+inline unsigned long benchClock()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000UL + now.tv_nsec;
+}
+#endif
+
+// Times each part is repeated to average out the clock's resolution.
+#ifndef BENCH_PASSES
+#define BENCH_PASSES 10
+#endif
+
+// Lines in the style of a CAM post processor, exercising the number parser,
+// every modal group and both arc forms.
+#define BENCH_CORPUS_LINES 12
+const char BENCH_CORPUS[BENCH_CORPUS_LINES][40] PROGMEM =
+{
+  "G21 G90 G17",
+  "G00 X-12.500 Y95.250",
+  "M10",
+  "G01 X-11.982 Y96.114 F1500.0",
+  "G01 X-10.875 Y97.520",
+  "g1 x-9.1250 y98.0625 (lower case)",
+  "G02 X-5.125 Y102.0625 I4.000 J0",
+  "G03 X2.375 Y104.500 R8.000",
+  "G01 X14.125 Y110.875 Z0.000",
+  "G04 P0.1",
+  "M11",
+  "G00 X0 Y120"
+};
+
+// A processor which accepts everything and does nothing else, so only the
+// parser is timed.
+class NullProcessor final : public GCodeProcessor
+{
+public:
+  NullProcessor()
+  {
+    _x = 0;
+    _y = 0;
+    _z = 0;
+  }
+
+  void park() { }
+  float getX() { return _x; }
+  float getY() { return _y; }
+  float getZ() { return _z; }
+  float getA() { return 0; }
+  float getB() { return 0; }
+  float getC() { return 0; }
+  void setFeedrate(float f) { }
+  void setHome(float x, float y, float z, float a, float b, float c) { }
+  void enableVacuum(boolean enable) { }
+  void dwell(float seconds) { }
+
+  void setPosition(float x, float y, float z, float a, float b, float c)
+  {
+    _x = x;
+    _y = y;
+    _z = z;
+  }
+
+  void movePosition(float x, float y, float z, float a, float b, float c)
+  {
+    setPosition(x, y, z, a, b, c);
+  }
+
+private:
+  float _x;
+  float _y;
+  float _z;
+};
+
+/**
+ * benchPrint - prints a JSON member with the time per item.
+ * @param name - the member name.
+ * @param elapsed - clock ticks taken.
+ * @param count - number of items processed in that time.
+ */
+void benchPrint(const char *name, unsigned long elapsed, float count)
+{
+  Serial.print(F(", \""));
+  Serial.print(name);
+  Serial.print(F("\": "));
+  Serial.print((float)elapsed * BENCH_UNITS_PER_TICK / count);
+}
+
+/**
+ * benchParser - times Parser::parseLine per line of the corpus.
+ */
+unsigned long benchParser(int *lines)
+{
+  NullProcessor processor;
+  Parser<NullProcessor> parser(&processor);
+  char line[40];
+  unsigned long elapsed = 0;
+  *lines = 0;
+
+  for (int pass = 0; pass < BENCH_PASSES; pass++)
+  {
+    for (int i = 0; i < BENCH_CORPUS_LINES; i++)
+    {
+      strcpy_P(line, BENCH_CORPUS[i]);
+      unsigned long start = benchClock();
+      parser.parseLine(line);
+      elapsed += benchClock() - start;
+      (*lines)++;
+    }
+  }
+  return elapsed;
+}
+
+/**
+ * benchKinematics - times the arm's setPosition across a grid covering the
+ * work area, including points out of reach.
+ */
+template <class Arm>
+unsigned long benchKinematics(Arm *arm, int *solves)
+{
+  *solves = 0;
+  unsigned long start = benchClock();
+  for (int pass = 0; pass < BENCH_PASSES; pass++)
+  {
+    for (int y = 0; y <= 200; y += 10)
+    {
+      for (int x = -200; x <= 200; x += 10)
+      {
+        arm->setPosition((float)x, (float)y, 0, 0, 0, 0);
+        (*solves)++;
+      }
+    }
+  }
+  return benchClock() - start;
+}
+
+/**
+ * benchMotion - times planning and executing a zig zag of moves, through
+ * Planner::movePosition and the Executor's ticks down to the servos.
+ */
+unsigned long benchMotion(Planner *planner, Executor *executor, float *millimeters)
+{
+  planner->park();
+  float lastX = planner->getX();
+  float lastY = planner->getY();
+  *millimeters = 0;
+
+  unsigned long start = benchClock();
+  for (int i = 0; i < 4 * BENCH_PASSES; i++)
+  {
+    float x = (i % 2) ? 40 : -40;
+    float y = 80 + 5 * (i % 8);
+    while (!planner->ready())
+    {
+      executor->tick();
+    }
+    planner->movePosition(x, y, 0, 0, 0, 0);
+    *millimeters += sqrt((x - lastX) * (x - lastX) + (y - lastY) * (y - lastY));
+    lastX = x;
+    lastY = y;
+  }
+  while (!planner->idle())
+  {
+    executor->tick();
+  }
+  return benchClock() - start;
+}
+
+/**
+ * runBenchmarks - runs each benchmark and prints the results as JSON.
+ */
+template <class Arm>
+void runBenchmarks(Arm *arm, Planner *planner, Executor *executor)
+{
+  int lines, solves;
+  float millimeters;
+  unsigned long parserTime = benchParser(&lines);
+  unsigned long ikTime = benchKinematics(arm, &solves);
+  unsigned long motionTime = benchMotion(planner, executor, &millimeters);
+
+  Serial.print(F("{\"unit\": \"" BENCH_UNIT "\", \"ik\": \""));
+#if defined(IK_LOOKUP_TABLE)
+  Serial.print(F("table"));
+#elif defined(FIXED_POINT_IK)
+  Serial.print(F("fixed"));
+#else
+  Serial.print(F("float"));
+#endif
+  Serial.print(F("\""));
+  benchPrint("parse_line", parserTime, lines);
+  benchPrint("ik_solve", ikTime, solves);
+  benchPrint("move_mm", motionTime, millimeters);
+  Serial.println(F("}"));
+}
+
+#endif  // Benchmark_H
+
+/*
+┌──────────────────────────────────────────────────────────────────────────┐
+│                                                   TERMS OF USE: MIT License                                                   │
+├──────────────────────────────────────────────────────────────────────────┤
+│Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation     │
+│files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,     │
+│modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software │
+│is furnished to do so, subject to the following conditions:                                                                    │
+│                                                                                                                               │
+│The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. │
+│                                                                                                                               │
+│THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE           │
+│WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR          │
+│COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,    │
+│ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                          │
+└──────────────────────────────────────────────────────────────────────────┘
+*/
+
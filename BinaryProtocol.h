@@ -0,0 +1,338 @@
+//------------------------------------------------------------------------------
+// Binary protocol - a compact alternative to G-code text for senders which
+// stream long jobs. A move takes 5 to 9 bytes rather than 20 or more of text,
+// and decoding it is a few shifts instead of scanning numbers.
+//
+// The sender switches to it by sending the line "$B", and once that is
+// answered with "ok" the bytes it sends are frames. Waiting for the "ok"
+// matters, as until then bytes such as '?' are taken as realtime commands:
+//
+//   0xA5 | type | sequence | payload | CRC-8
+//
+// The sequence byte counts from 0 after the handshake and wraps at 256, far
+// more frames than fit in the receive buffer at once. Payloads are
+// little-endian, with coordinates in hundredths of a mm. The CRC-8 uses the
+// polynomial 0x07 over the type, sequence and payload.
+//
+// Each frame executed is answered with "ok", so character counting senders
+// work unchanged. A frame which is damaged or out of sequence is answered
+// with "[RESEND:n]", and frames are dropped until frame n arrives intact.
+// A 0xA5 which turns out not to start a frame is skipped, and the bytes
+// after it are searched again for the real start. The FRAME_END frame
+// returns to G-code text, as does FRAME_TIMEOUT without a byte while the
+// sender owes the next frame, so a sender which went away leaves the
+// board taking text.
+//
+// Realtime commands are sent as FRAME_REALTIME frames with sequence 0 and
+// the command's byte as payload. They are taken as they arrive, ahead of
+// the frames waiting in the receive buffer, and are neither answered nor
+// counted against it. A soft reset returns to G-code text.
+//------------------------------------------------------------------------------
+// Copyright at end of file.
+
+#ifndef BinaryProtocol_H
+#define BinaryProtocol_H
+
+// Marks the start of a frame.
+#define FRAME_SYNC 0xA5
+
+// Frame coordinates are in hundredths of a mm.
+#define FRAME_UNITS_PER_MM 100
+
+#define FRAME_MAX_PAYLOAD 6
+
+// Sync, type, sequence and CRC bytes around the payload.
+#define FRAME_OVERHEAD 4
+
+// Frame types and their payloads.
+#define FRAME_LINEAR 0    // int16 x, y
+#define FRAME_RAPID 1     // int16 x, y
+#define FRAME_STEP 2      // int8 dx, dy, a linear move from the position
+#define FRAME_LINEAR_Z 3  // int16 x, y, z
+#define FRAME_FEED 4      // uint16 mm/min
+#define FRAME_DWELL 5     // uint16 milliseconds
+#define FRAME_HOME 6      // none, parks the arm
+#define FRAME_VACUUM 7    // uint8 1 on or 0 off
+#define FRAME_RAPID_Z 8   // int16 x, y, z
+#define FRAME_REALTIME 14 // uint8 realtime command, sequence 0
+#define FRAME_END 15      // none, returns to G-code
+
+// Milliseconds without a byte while the sender owes the next frame, after
+// which the input returns to G-code text.
+#ifndef FRAME_TIMEOUT
+#define FRAME_TIMEOUT 5000
+#endif
+
+// Results of FrameDecoder::add.
+#define FRAME_INCOMPLETE 0
+#define FRAME_READY 1
+#define FRAME_RESEND 2
+
+/**
+ * framePayloadSize - bytes of payload carried by a frame type.
+ * @return the size, or -1 for an unknown type.
+ */
+inline int framePayloadSize(byte type)
+{
+  switch (type)
+  {
+  case FRAME_LINEAR:
+  case FRAME_RAPID:
+    return 4;
+  case FRAME_STEP:
+  case FRAME_FEED:
+  case FRAME_DWELL:
+    return 2;
+  case FRAME_LINEAR_Z:
+  case FRAME_RAPID_Z:
+    return 6;
+  case FRAME_VACUUM:
+  case FRAME_REALTIME:
+    return 1;
+  case FRAME_HOME:
+  case FRAME_END:
+    return 0;
+  default:
+    return -1;
+  }
+}
+
+/**
+ * crc8Update - adds a byte to a CRC-8 with polynomial 0x07.
+ */
+inline byte crc8Update(byte crc, byte data)
+{
+  crc ^= data;
+  for (byte i = 0; i < 8; i++)
+  {
+    crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+  }
+  return crc;
+}
+
+// Assembles frames from received bytes and checks their CRC and sequence.
+class FrameDecoder
+{
+public:
+  FrameDecoder()
+  {
+    begin();
+  }
+
+  /**
+   * Expects the first frame after the handshake.
+   */
+  void begin()
+  {
+    _length = 0;
+    _expected = 0;
+    _resending = false;
+    _held = false;
+  }
+
+  /**
+   * Adds a received byte to the frame being assembled.
+   * @return FRAME_READY when the expected frame is complete, FRAME_RESEND
+   *   when a frame was dropped so the sender must resend from expected(),
+   *   otherwise FRAME_INCOMPLETE.
+   */
+  byte add(byte c)
+  {
+    _frame[_length++] = c;
+    return scan();
+  }
+
+  /**
+   * Returns true while bytes kept from a dropped frame follow the ready
+   * frame, to be scanned before more are added.
+   */
+  boolean held()
+  {
+    return _held;
+  }
+
+  /**
+   * Looks for the expected frame in the bytes kept, dropping any before it
+   * which do not make a frame. Each rejected sync byte is dropped alone, as
+   * a real frame may start among the bytes after it.
+   * @return the result as for add.
+   */
+  byte scan()
+  {
+    _held = false;
+    boolean resend = false;
+    for (;;)
+    {
+      if (_length == 0)
+      {
+        break;
+      }
+      if (_frame[0] != FRAME_SYNC)
+      {
+        // Bytes between frames are noise, skip to the next sync.
+        discard(1);
+        continue;
+      }
+      if (_length < 2)
+      {
+        break;
+      }
+      int size = framePayloadSize(type());
+      if (size < 0)
+      {
+        resend = true;
+        discard(1);
+        continue;
+      }
+      if (_length < size + FRAME_OVERHEAD)
+      {
+        break;
+      }
+
+      byte crc = 0;
+      for (byte i = 1; i < size + FRAME_OVERHEAD - 1; i++)
+      {
+        crc = crc8Update(crc, _frame[i]);
+      }
+      if (crc != _frame[size + FRAME_OVERHEAD - 1])
+      {
+        resend = true;
+        discard(1);
+        continue;
+      }
+      if (type() == FRAME_REALTIME)
+      {
+        // Realtime frames are taken from the input as they arrive, so one
+        // which gets here holds no command and is skipped.
+        discard(size + FRAME_OVERHEAD);
+        continue;
+      }
+      if (_frame[2] != _expected)
+      {
+        // Frames after a damaged one are expected, the sender has already
+        // been asked to resend.
+        resend = resend || !_resending;
+        discard(size + FRAME_OVERHEAD);
+        continue;
+      }
+
+      _resending = false;
+      return FRAME_READY;
+    }
+
+    if (resend)
+    {
+      _resending = true;
+      return FRAME_RESEND;
+    }
+    return FRAME_INCOMPLETE;
+  }
+
+  /**
+   * Finishes with the ready frame, so the next in sequence is expected.
+   */
+  void next()
+  {
+    discard(framePayloadSize(type()) + FRAME_OVERHEAD);
+    _held = _length > 0;
+    _expected++;
+  }
+
+  /**
+   * The sequence number of the frame expected next.
+   */
+  byte expected()
+  {
+    return _expected;
+  }
+
+  byte type()
+  {
+    return _frame[1];
+  }
+
+  /**
+   * The byte at an offset in the ready frame's payload.
+   */
+  byte payload(byte offset)
+  {
+    return _frame[3 + offset];
+  }
+
+  /**
+   * The signed 16-bit value at an offset in the ready frame's payload.
+   */
+  int16_t word(byte offset)
+  {
+    return (int16_t)(_frame[3 + offset] | (_frame[4 + offset] << 8));
+  }
+
+private:
+  // Bytes received which are not yet known to be noise, starting with the
+  // frame being assembled. There are never more than a frame's worth, as a
+  // frame is checked once its last byte arrives.
+  byte _frame[FRAME_MAX_PAYLOAD + FRAME_OVERHEAD];
+  byte _length;
+  byte _expected;
+
+  // True from a damaged frame until the resent frame arrives.
+  boolean _resending;
+
+  // True while bytes after the ready frame are still to be scanned.
+  boolean _held;
+
+  /**
+   * Removes bytes from the front of those kept.
+   */
+  void discard(byte count)
+  {
+    _length -= count;
+    for (byte i = 0; i < _length; i++)
+    {
+      _frame[i] = _frame[i + count];
+    }
+  }
+};
+
+/**
+ * writeFrame - encodes a frame, for senders.
+ * @param out - receives the frame, at least FRAME_MAX_PAYLOAD +
+ *   FRAME_OVERHEAD bytes.
+ * @return the length of the frame.
+ */
+inline byte writeFrame(byte type, byte sequence, const byte *payload, byte *out)
+{
+  byte size = framePayloadSize(type);
+  out[0] = FRAME_SYNC;
+  out[1] = type;
+  out[2] = sequence;
+  byte crc = crc8Update(crc8Update(0, type), sequence);
+  for (byte i = 0; i < size; i++)
+  {
+    out[3 + i] = payload[i];
+    crc = crc8Update(crc, payload[i]);
+  }
+  out[3 + size] = crc;
+  return size + FRAME_OVERHEAD;
+}
+
+#endif  // BinaryProtocol_H
+
+/*
+┌──────────────────────────────────────────────────────────────────────────┐
+│                                                   TERMS OF USE: MIT License                                                   │
+├──────────────────────────────────────────────────────────────────────────┤
+│Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation     │
+│files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,     │
+│modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software │
+│is furnished to do so, subject to the following conditions:                                                                    │
+│                                                                                                                               │
+│The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. │
+│                                                                                                                               │
+│THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE           │
+│WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR          │
+│COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,    │
+│ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                          │
+└──────────────────────────────────────────────────────────────────────────┘
+*/
+
@@ -1,45 +1,314 @@
+// Define to generate the servo pulses from Timer1 with the PulseEngine rather
+// than the Servo library, so both joints change in the same frame.
+// #define PULSE_ENGINE
+
+// Define to count inverse kinematics solutions, loop latency, queue
+// starvation and unreachable positions, which are added to status reports.
+// #define PERF_COUNTERS
+
+// Define to drive a polar plotter, whose pen rides a slide along an arm
+// turning about the pillar, rather than the scara arm.
+// #define POLAR_PLOTTER
+
+// Define to keep jobs on an SD card, uploaded with $U=name and run with
+// $R=name. The SD library needs more RAM than an Uno has to spare.
+// #define JOB_STORAGE
+
+// Define to drive a second scara arm from the same board, which takes its own
+// job on Serial1 and has its servos on pins 4 and 5, and its pen on 7. Needs
+// a board with a second serial port, such as the Mega.
+// #define SECOND_ARM
+
+#if defined(SECOND_ARM) && defined(POLAR_PLOTTER)
+#error "SECOND_ARM drives scara arms only."
+#endif
+#if defined(PULSE_ENGINE) && !defined(POLAR_PLOTTER)
+#ifdef SECOND_ARM
+// Both arms' servos share the engine's frame.
+#define PULSE_CHANNELS 6
+#else
+// The shoulder, elbow and pen.
+#define PULSE_CHANNELS 3
+#endif
+#endif
+
 #include <Arduino.h>
+#ifndef PULSE_ENGINE
+// The pulse engine replaces the Servo library, whose Timer1 interrupt it
+// would clash with.
 #include <Servo.h>
+#endif
+#ifdef POLAR_PLOTTER
+#include "PolarArm.h"
+#else
 #include "ScaraArm.h"
+#endif
+#include "ArmScheduler.h"
+
+// Define to time the parser, kinematics and motion at startup and print the
+// results as JSON. The servos are left detached so the arm does not move.
+// #define BENCHMARK
+
+#ifdef BENCHMARK
+#include "Benchmark.h"
+#endif
 
-int HUMERUS = 103;
-int ULNA = 100;
+#ifdef POLAR_PLOTTER
+// The pen reaches from 40 to 160 mm out, moved by a 40 mm pinion.
+PolarArm<40, 160, 40> robotArm(0, 0);
+#else
+const int HUMERUS = 103;
+const int ULNA = 100;
 
-ScaraArm robotArm(HUMERUS, ULNA, 0, 0, 20);
+ScaraArm<HUMERUS, ULNA> robotArm(0, 0);
+#ifdef SECOND_ARM
+ScaraArm<HUMERUS, ULNA> secondArm(0, 0);
+#endif
+#endif
 
+// Pulse widths measured at Pi/8 steps of each servo horn, in order of joint
+// angle. Measured against the horn,
+//   elbow Pi = 2390, 7Pi/8 = 2170, 3Pi/4 = 1956, 5Pi/8 = 1730, Pi/2 = 1500, 3Pi/8 = 1270, Pi/4 = 1050, Pi/8 = 840, 0 = 640
+//   shoulder Pi = 685, 7Pi/8 = 882, 3Pi/4 = 1080, 5Pi/8 = 1290, Pi/2 = 1500, 3Pi/8 = 1737, Pi/4 = 1975, Pi/8 = 2200, 0 = 2450
+// Both joints turn opposite to their horns. The tables are placed so the
+// 1500 us center falls at the same joint angle as in the linear calibration
+// held in the settings, whose center and slope were tuned on the arm.
+const int16_t SHOULDER_CALIBRATION[9] PROGMEM = { 685, 882, 1080, 1290, 1500, 1737, 1975, 2200, 2450 };
+const int16_t ELBOW_CALIBRATION[9] PROGMEM = { 2390, 2170, 1956, 1730, 1500, 1270, 1050, 840, 640 };
+
+#ifdef PULSE_ENGINE
+// Generates the pulses for both joints' servos.
+PulseEngine pulses;
+#elif defined(POLAR_PLOTTER)
+Servo turnServo;
+Servo slideServo;
+#else
 // Create and configure servos here, use dependancy injection to provide them to the joint class.
 Servo shoulderServo;
 Servo elbowServo;
+Servo penServo;
+#ifdef SECOND_ARM
+Servo secondShoulderServo;
+Servo secondElbowServo;
+Servo secondPenServo;
+#endif
+#endif
 
-Parser parser(&robotArm);
+// Settings used until others are stored with $n=value, in the order of the
+// SETTING_ numbers in Settings.h.
+#ifdef POLAR_PLOTTER
+// Both servos turn 90 degrees per 1000 us and are centered at 1500 us. The
+// plotter has no pen lift, so the pen settings are unused.
+const float SETTING_DEFAULTS[SETTINGS_COUNT] PROGMEM = {
+  1500, 637, 1500, 637, 0, 0, 3000, 500, 0.05, 0, 0, 1500, 0, 0, 0, 0 };
+#else
+// Hobby servos turn about 60 degrees in 0.15 s unloaded. The joint limits
+// leave margin for the arm's inertia, moves are slowed where the joints
+// would exceed them. The pen servo's horn lifts the pen 1 mm per 40 us, from
+// pressing 1 mm into the paper up to 5 mm above it in 0.25 s.
+const float SETTING_DEFAULTS[SETTINGS_COUNT] PROGMEM = {
+  995, 560, 2300, -563, 0, 0, 3000, 500, 0.05, 5.0, 50.0, 1300, 40, 5, -1, 0.25 };
+#endif
 
-// Perform one time setup and initialization.
-void setup()
+// The arm's planner, parser and executor, taking commands on Serial.
+ArmStation station(&robotArm, &serialRx);
+Planner &planner = station.planner;
+Parser<Planner> &parser = station.parser;
+Executor &executor = station.executor;
+
+#ifdef SECOND_ARM
+// The second arm's, taking commands on Serial1.
+RxBuffer secondRx(&Serial1);
+ArmStation secondStation(&secondArm, &secondRx);
+#endif
+
+// Services each arm in turn.
+ArmScheduler arms;
+
+// Copies the settings shared by every kind of arm into the planners. Arms
+// sharing the board are built alike, so they share the settings too.
+void applyMotionSettings()
+{
+  for (byte i = 0; i < arms.count(); i++)
+  {
+    Planner *p = &arms.station(i)->planner;
+    p->setFeedrate(settings.get(SETTING_FEEDRATE));
+    p->setAcceleration(settings.get(SETTING_ACCELERATION), settings.get(SETTING_JUNCTION_DEVIATION));
+    p->setHome(settings.get(SETTING_X_OFFSET), settings.get(SETTING_Y_OFFSET), 0, 0, 0, 0);
+  }
+}
+
+// Settings are only changed with every arm idle, as they apply to all.
+boolean armsIdle()
+{
+  return arms.idle();
+}
+
+#ifdef POLAR_PLOTTER
+// Attaches the joints to their servos.
+void setupArm()
+{
+#ifdef PULSE_ENGINE
+  robotArm._turn.setParameters(&pulses, pulses.attach(2, 500, 2500),
+    settings.get(SETTING_JOINT1_CENTER), settings.get(SETTING_JOINT1_SCALE));
+  robotArm._slide.setParameters(&pulses, pulses.attach(3, 500, 2500),
+    settings.get(SETTING_JOINT2_CENTER), settings.get(SETTING_JOINT2_SCALE));
+#ifndef BENCHMARK
+  pulses.begin();
+#endif
+#else
+#ifndef BENCHMARK
+  turnServo.attach(2, 500, 2500);
+  slideServo.attach(3, 500, 2500);
+#endif
+  robotArm._turn.setParameters(&turnServo,
+    settings.get(SETTING_JOINT1_CENTER), settings.get(SETTING_JOINT1_SCALE));
+  robotArm._slide.setParameters(&slideServo,
+    settings.get(SETTING_JOINT2_CENTER), settings.get(SETTING_JOINT2_SCALE));
+#endif
+}
+
+// Copies the settings into the arm and planner.
+void applySettings()
+{
+  robotArm._turn.setScaling(settings.get(SETTING_JOINT1_CENTER), settings.get(SETTING_JOINT1_SCALE));
+  robotArm._slide.setScaling(settings.get(SETTING_JOINT2_CENTER), settings.get(SETTING_JOINT2_SCALE));
+  applyMotionSettings();
+}
+#else
+#ifdef PULSE_ENGINE
+// Attaches an arm's joints to the next channels of the pulse engine.
+void attachArm(ScaraArm<HUMERUS, ULNA> *arm, byte shoulderPin, byte elbowPin, byte penPin)
+{
+  arm->_shoulder.setParameters(&pulses, pulses.attach(shoulderPin, 500, 2500),
+    settings.get(SETTING_JOINT1_CENTER), settings.get(SETTING_JOINT1_SCALE));
+  arm->_elbow.setParameters(&pulses, pulses.attach(elbowPin, 500, 2500),
+    settings.get(SETTING_JOINT2_CENTER), settings.get(SETTING_JOINT2_SCALE));
+  arm->_pen.setParameters(&pulses, pulses.attach(penPin, 500, 2500),
+    settings.get(SETTING_PEN_CENTER), settings.get(SETTING_PEN_SCALE));
+}
+#else
+// Attaches an arm's joints to their servos.
+void attachArm(ScaraArm<HUMERUS, ULNA> *arm, Servo *shoulder, byte shoulderPin, Servo *elbow, byte elbowPin,
+               Servo *pen, byte penPin)
+{
+#ifndef BENCHMARK
+  shoulder->attach(shoulderPin, 500, 2500);
+  elbow->attach(elbowPin, 500, 2500);
+  pen->attach(penPin, 500, 2500);
+#endif
+  arm->_shoulder.setParameters(shoulder,
+    settings.get(SETTING_JOINT1_CENTER), settings.get(SETTING_JOINT1_SCALE));
+  arm->_elbow.setParameters(elbow,
+    settings.get(SETTING_JOINT2_CENTER), settings.get(SETTING_JOINT2_SCALE));
+  arm->_pen.setParameters(pen,
+    settings.get(SETTING_PEN_CENTER), settings.get(SETTING_PEN_SCALE));
+}
+#endif
+
+// Attaches the joints to their servos.
+void setupArm()
+{
+#ifdef PULSE_ENGINE
+  attachArm(&robotArm, 2, 3, 6);
+#ifdef SECOND_ARM
+  attachArm(&secondArm, 4, 5, 7);
+#endif
+#ifndef BENCHMARK
+  pulses.begin();
+#endif
+#else
+  attachArm(&robotArm, &shoulderServo, 2, &elbowServo, 3, &penServo, 6);
+#ifdef SECOND_ARM
+  attachArm(&secondArm, &secondShoulderServo, 4, &secondElbowServo, 5, &secondPenServo, 7);
+#endif
+#endif
+}
+
+// Copies the joint settings into an arm.
+void applyArmSettings(ScaraArm<HUMERUS, ULNA> *arm)
 {
-  shoulderServo.attach(2, 500, 2500);
-  elbowServo.attach(3, 500, 2500);
-  robotArm._shoulder.setParameters(&shoulderServo, 995, 560); // 510); // should probably be 560
-  robotArm._elbow.setParameters(&elbowServo, 2300, -563);
+  float shoulderCenter = settings.get(SETTING_JOINT1_CENTER);
+  float shoulderScale = settings.get(SETTING_JOINT1_SCALE);
+  float elbowCenter = settings.get(SETTING_JOINT2_CENTER);
+  float elbowScale = settings.get(SETTING_JOINT2_SCALE);
+  arm->_shoulder.setScaling(shoulderCenter, shoulderScale);
+  arm->_elbow.setScaling(elbowCenter, elbowScale);
+
+  float velocity = settings.get(SETTING_JOINT_VELOCITY);
+  float acceleration = settings.get(SETTING_JOINT_ACCELERATION);
+  arm->_shoulder.setLimits(velocity, acceleration);
+  arm->_elbow.setLimits(velocity, acceleration);
 
- // elbow Pi = 2390, 7Pi/8 = 2170, 3Pi/4 = 1956, 5Pi/8 = 1730, Pi/2 = 1500, 3Pi/8 = 1270, Pi/4 = 1050, Pi/8 = 840, 0 = 640
+  arm->_pen.setScaling(settings.get(SETTING_PEN_CENTER), settings.get(SETTING_PEN_SCALE));
+  arm->setPenLimits(settings.get(SETTING_PEN_UP), settings.get(SETTING_PEN_DOWN),
+    settings.get(SETTING_PEN_SECONDS));
+
+  // The servos are not linear, so use the measured pulse widths instead.
+  arm->_shoulder.setCalibration(SHOULDER_CALIBRATION, 9,
+    (1500 - shoulderCenter) / shoulderScale - PI / 2, PI / 8);
+  arm->_elbow.setCalibration(ELBOW_CALIBRATION, 9,
+    (1500 - elbowCenter) / elbowScale - PI / 2, PI / 8);
+}
 
- // shoulder Pi = 685, 7Pi/8 = 882, 3Pi/4 = 1080, 5Pi/8 = 1290, Pi/2 = 1500, 3Pi/8 = 1737, Pi/4 = 1975, Pi/8 = 2200, 0 = 2450
+// Copies the settings into the arms and planners.
+void applySettings()
+{
+  applyArmSettings(&robotArm);
+#ifdef SECOND_ARM
+  applyArmSettings(&secondArm);
+#endif
+  applyMotionSettings();
+}
+#endif
 
+// Perform one time setup and initialization. Nothing waits, so the arm
+// answers as soon as the serial port is up.
+void setup()
+{
   Serial.begin( 57300 );
-  delay( 3000 );
+#ifdef SECOND_ARM
+  Serial1.begin( 57300 );
+#endif
+  arms.add(&station);
+#ifdef SECOND_ARM
+  arms.add(&secondStation);
+#endif
+  boolean loaded = settings.begin(SETTING_DEFAULTS, applySettings, armsIdle);
+  setupArm();
+  applySettings();
+#ifdef JOB_STORAGE
+  // Without a card uploads and runs fail when asked for.
+  jobs.begin();
+#endif
 
   // Identify as GRBL so I can use the CNC GUI.
-  parser.reportMessage(STATUS_VERSION);
-  parser.reset();
+  for (byte i = 0; i < arms.count(); i++)
+  {
+    Parser<Planner> *p = &arms.station(i)->parser;
+    p->reportMessage(STATUS_VERSION);
+    if (!loaded)
+    {
+      p->reportMessage(STATUS_SETTING_READ_FAIL);
+    }
+  }
+
+#ifdef BENCHMARK
+  runBenchmarks(&robotArm, &planner, &executor);
+#endif
 
-  robotArm.park();
+  arms.begin();
 }
 
 // This is called in a tight loop.
-// The parser awaits input and acts upon it.
+// Each arm queues any available input and advances its motion in turn.
+// Nothing blocks, so realtime commands are acted upon within one pass.
 void loop()
 {
-  parser.listen();
+#ifdef PERF_COUNTERS
+  perf.loopStarted();
+#endif
+  arms.run();
 }
 
 //------------------------------------------------------------------------------
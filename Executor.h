@@ -0,0 +1,775 @@
+//------------------------------------------------------------------------------
+// Executor class - advances the planner's current block from a periodic tick
+// rather than blocking in delay(). The ticks are counted out of micros(), so
+// a host build can drive a simulated clock, and run() returns promptly so
+// loop() can keep servicing serial input while the arm moves.
+//
+// Each tick finds how far along its velocity profile the move should be by
+// then, so every interpolated point is due when the distance to it has been
+// covered at the planned speed. Late ticks are caught up on the next run(),
+// and the part of a tick left over is carried forward rather than dropped,
+// so the tool keeps to the commanded feed whatever loop() costs.
+//
+// A feed hold and the feed override both work by scaling the rate at which
+// time passes along the planned velocity profile, so the path and the plan
+// are untouched. The rate is eased so the tool's speed changes no faster
+// than the block's acceleration, and a hold stops partway along a block and
+// carries on from there when the cycle is started again. Above 100% the
+// accelerations grow with the square of the override as well.
+//
+// Z is the height of the pen, which draws at Z = 0 and below. A block which
+// changes it sends the pen first and waits for it, going by the machine's
+// model of how long its pen servo takes. A rising pen is only waited for
+// until it is clear of the paper, a falling one until it has settled. The
+// pen may also be sent while the block before is still decelerating, as
+// long as a pen on the paper stays down until the stroke ends and a pen
+// above it stays clear until the travel ends, so ink is never dragged. A
+// hold sends such a pen back to the held block's height, and the block
+// waits for it when the cycle is started again.
+//------------------------------------------------------------------------------
+// Copyright at end of file.
+
+#ifndef Executor_H
+#define Executor_H
+
+#include "Planner.h"
+#ifdef PERF_COUNTERS
+#include "PerfCounters.h"
+#endif
+
+// Tick frequency. Motion and dwell timing is counted in ticks.
+#define EXECUTOR_TICK_HZ 1000
+#define TICK_SECONDS (1.0 / EXECUTOR_TICK_HZ)
+#define TICK_MICROS (1000000UL / EXECUTOR_TICK_HZ)
+
+// Distance in mm between interpolated points. The position is stepped in
+// fixed point, so this may be a fraction of a millimeter.
+#ifndef STEP_SIZE
+#define STEP_SIZE 0.5
+#endif
+
+// Fractional bits of the fixed point position stepped along a move.
+#define DDA_FRACTION_BITS 16
+#define DDA_ONE (1L << DDA_FRACTION_BITS)
+
+// Idle gaps between moves shorter than this are counted as the queue
+// starving, longer ones are taken as the job having ended.
+#define STARVED_GAP_TICKS EXECUTOR_TICK_HZ
+
+// Limits of the feed override in percent, and its coarse and fine steps.
+#define FEED_OVERRIDE_MIN 10
+#define FEED_OVERRIDE_MAX 200
+#define FEED_OVERRIDE_COARSE 10
+#define FEED_OVERRIDE_FINE 1
+
+// Height in mm above the paper a pen must be before travel starts, and
+// which a falling pen must not pass before the travel ends. It leaves
+// margin for the pen servo being slower than modelled.
+#ifndef PEN_CLEARANCE
+#define PEN_CLEARANCE 1.0
+#endif
+
+// Ticks counted since the pen was sent, after which it has surely settled.
+#define PEN_SETTLED_TICKS 60000U
+
+// Executor states.
+#define EXEC_IDLE 0
+#define EXEC_MOVING 1
+#define EXEC_DWELLING 2
+#define EXEC_PEN 3
+
+#ifdef __AVR__
+// Timer2 prescaler for the tick, the smallest which keeps the compare value
+// in its 8 bits at this clock, such as clk/64 at 16 MHz and clk/128 at 20.
+#if F_CPU / 64 / EXECUTOR_TICK_HZ <= 256
+#define TIMER2_PRESCALER 64
+#define TIMER2_CLOCK_SELECT _BV(CS22)
+#elif F_CPU / 128 / EXECUTOR_TICK_HZ <= 256
+#define TIMER2_PRESCALER 128
+#define TIMER2_CLOCK_SELECT (_BV(CS22) | _BV(CS20))
+#elif F_CPU / 256 / EXECUTOR_TICK_HZ <= 256
+#define TIMER2_PRESCALER 256
+#define TIMER2_CLOCK_SELECT (_BV(CS22) | _BV(CS21))
+#elif F_CPU / 1024 / EXECUTOR_TICK_HZ <= 256
+#define TIMER2_PRESCALER 1024
+#define TIMER2_CLOCK_SELECT (_BV(CS22) | _BV(CS21) | _BV(CS20))
+#else
+#error "EXECUTOR_TICK_HZ is too slow for Timer2 at this F_CPU"
+#endif
+
+// Drains the serial ports into their receive rings about once a tick, which
+// at 57300 baud gains under six bytes each in between. Other interrupts stay
+// enabled so the copy does not delay the edges of servo pulses. The timer is
+// not used to count ticks, as at clocks such as 20 MHz its period is not a
+// whole number of counts and it would drift.
+ISR(TIMER2_COMPA_vect, ISR_NOBLOCK)
+{
+  fillRxBuffers();
+}
+#endif
+
+class Executor
+{
+public:
+  /**
+   * Constructor used to bind the executor to its block source and machine.
+   * @param planner - queue of blocks to execute.
+   * @param machine - the robot which is positioned at each step.
+   */
+  Executor(Planner *planner, GCodeProcessor *machine)
+  {
+    _planner = planner;
+    _machine = machine;
+    _lastMicros = 0;
+    _state = EXEC_IDLE;
+    _distance = 0;
+    reset();
+    _penTicks = PEN_SETTLED_TICKS;
+  }
+
+  /**
+   * Abandons the active block where it is, for a soft reset. The planner
+   * is cleared separately. Holds and the feed override are cancelled.
+   */
+  void reset()
+  {
+    if (_state == EXEC_MOVING)
+    {
+      _distance += distanceAt(_time);
+    }
+    _state = EXEC_IDLE;
+    _countdown = 0;
+    _time = 0;
+    _hold = false;
+    _override = 100;
+    _rate = 1;
+
+    // The pen stays wherever it was left.
+    _penZ = _machine->getZ();
+    _penFrom = _penZ;
+#ifdef PERF_COUNTERS
+    _idleTicks = STARVED_GAP_TICKS;
+#endif
+  }
+
+  /**
+   * Starts the clock, and on the ATmega the serial interrupt. Timer2 is used
+   * as the Servo library, or the pulse engine, owns Timer1.
+   */
+  void begin()
+  {
+#ifdef __AVR__
+    noInterrupts();
+    TCCR2A = _BV(WGM21);      // CTC mode
+    TCCR2B = TIMER2_CLOCK_SELECT;
+    OCR2A = (F_CPU / TIMER2_PRESCALER / EXECUTOR_TICK_HZ) - 1;
+    TIMSK2 = _BV(OCIE2A);
+    interrupts();
+#endif
+    _lastMicros = micros();
+    _penZ = _machine->getZ();
+    _penFrom = _penZ;
+    _penTicks = PEN_SETTLED_TICKS;
+  }
+
+  /**
+   * Processes the ticks which elapsed since the last call. Called from loop().
+   * Only whole ticks are taken off the clock, the remainder counts towards
+   * the next call.
+   */
+  void run()
+  {
+    unsigned long elapsed = micros() - _lastMicros;
+    unsigned int ticks = elapsed / TICK_MICROS;
+    _lastMicros += ticks * TICK_MICROS;
+
+    while (ticks-- > 0)
+    {
+      tick();
+    }
+  }
+
+  /**
+   * Brings the motion to a smooth stop, which may be partway along a block.
+   * Ignored while there is nothing to execute, as grbl does.
+   */
+  void feedHold()
+  {
+    if (_state != EXEC_IDLE || !_planner->idle())
+    {
+      _hold = true;
+    }
+
+    // The move will stop short of where the pen was sent early for the
+    // next block, so send it back to this block's height.
+    if (_state == EXEC_MOVING && _penZ != _block->target[2])
+    {
+      sendPen(_block->target[2]);
+    }
+  }
+
+  /**
+   * Resumes motion after a feed hold. A move held partway waits for its
+   * pen first, as the hold may have sent it back.
+   */
+  void cycleStart()
+  {
+    boolean held = _hold;
+    _hold = false;
+    if (held && _state == EXEC_MOVING)
+    {
+      float wait = penWait();
+      _countdown = (wait > 0) ? (unsigned long)ceil(wait * EXECUTOR_TICK_HZ) : 0;
+    }
+  }
+
+  /**
+   * Sets the feed override, which scales the speed of the motion.
+   * @param percent - the new override, kept within the limits above.
+   */
+  void setFeedOverride(int percent)
+  {
+    _override = constrain(percent, FEED_OVERRIDE_MIN, FEED_OVERRIDE_MAX);
+  }
+
+  int getFeedOverride()
+  {
+    return _override;
+  }
+
+  /**
+   * Advances the active block by one tick, starting the next block when the
+   * current one completes.
+   */
+  void tick()
+  {
+    updateRate();
+    if (_penTicks < PEN_SETTLED_TICKS)
+    {
+      _penTicks++;
+    }
+    if (_state == EXEC_MOVING)
+    {
+      if (_countdown > 0)
+      {
+        // Resuming once the pen is back.
+        _countdown--;
+      }
+      if (_rate == 0)
+      {
+        // Held partway along the block.
+        return;
+      }
+      _time += TICK_SECONDS * _rate;
+      if (!_hold)
+      {
+        sendPenEarly();
+      }
+      if (_time < _profileTime)
+      {
+        unsigned int step = distanceAt(_time) / _stepLength;
+        if (step > _step && step < _steps)
+        {
+          advance(step);
+        }
+        return;
+      }
+
+      // Land exactly on the target, and carry the leftover time into the
+      // next block so back to back blocks keep their pace.
+      float *t = _block->target;
+      _machine->setPosition(t[0], t[1], t[2], t[3], t[4], t[5]);
+      _time -= _profileTime;
+      _distance += _block->millimeters;
+    }
+    else if (_state == EXEC_PEN)
+    {
+      // The pen keeps moving during a hold, the block waits for the cycle
+      // start to move.
+      if (_countdown > 0)
+      {
+        _countdown--;
+        return;
+      }
+      if (_hold)
+      {
+        return;
+      }
+      _state = EXEC_IDLE;
+      beginMove();
+      if (_state == EXEC_MOVING)
+      {
+        return;
+      }
+      _time = 0;
+    }
+    else if (_countdown > 0)
+    {
+      // A dwell is paused by a hold.
+      if (!_hold)
+      {
+        _countdown--;
+      }
+      return;
+    }
+    else
+    {
+      _time = 0;
+    }
+
+    // The current block is done, so release it and begin the next one. A
+    // hold only lets the motion run on into the next block if it does not
+    // stop between them.
+    boolean running = _state == EXEC_MOVING && _exitSpeed > 0;
+    if (_state != EXEC_IDLE)
+    {
+      _planner->discardCurrentBlock();
+      _state = EXEC_IDLE;
+    }
+    if (_hold && !running)
+    {
+      _rate = 0;
+    }
+    else
+    {
+      startBlock();
+    }
+
+#ifdef PERF_COUNTERS
+    if (_state == EXEC_IDLE)
+    {
+      if (_hold)
+      {
+        // Waiting on the operator is not starving.
+        _idleTicks = STARVED_GAP_TICKS;
+      }
+      else if (_idleTicks < STARVED_GAP_TICKS)
+      {
+        _idleTicks++;
+      }
+    }
+    else
+    {
+      if (_idleTicks < STARVED_GAP_TICKS)
+      {
+        perf.starvedTicks += _idleTicks;
+      }
+      _idleTicks = 0;
+    }
+#endif
+  }
+
+  boolean isIdle()
+  {
+    return _state == EXEC_IDLE;
+  }
+
+  /**
+   * Returns the speed the tool is moving at in mm/s, which follows the feed
+   * override and eases off for a hold.
+   */
+  float getSpeed()
+  {
+    return _state == EXEC_MOVING ? speedAt(_time) * _rate : 0;
+  }
+
+  /**
+   * Returns the distance in mm the tool has moved along linear blocks since
+   * the executor was made, which counts up like an odometer.
+   */
+  float getDistance()
+  {
+    return _state == EXEC_MOVING ? _distance + distanceAt(_time) : _distance;
+  }
+
+  /**
+   * Returns true from a feed hold until the cycle is started again.
+   */
+  boolean isHolding()
+  {
+    return _hold;
+  }
+
+  /**
+   * Returns true once a feed hold has brought the motion to a stop.
+   */
+  boolean isHeld()
+  {
+    return _hold && _rate == 0;
+  }
+
+private:
+  Planner * _planner;
+  GCodeProcessor * _machine;
+  MotionBlock * _block;
+  byte _state;
+
+  // Ticks to wait until a dwell ends, or the pen is where the block needs.
+  unsigned long _countdown;
+
+  // Height the pen was last sent to and the height it was sent from, and
+  // the ticks since, up to PEN_SETTLED_TICKS.
+  float _penZ;
+  float _penFrom;
+  unsigned int _penTicks;
+
+  // Millimeters of the linear blocks completed or abandoned.
+  float _distance;
+
+  // Set by a feed hold, and the feed override in percent. The rate is the
+  // seconds of the velocity profile which pass per second, easing towards
+  // zero while holding and towards the override otherwise.
+  boolean _hold;
+  int _override;
+  float _rate;
+
+#ifdef PERF_COUNTERS
+  // Ticks idle since the last block, up to STARVED_GAP_TICKS.
+  unsigned int _idleTicks;
+#endif
+  // micros() at the start of the next tick to process.
+  unsigned long _lastMicros;
+
+  // Position along the active linear move in DDA_FRACTION_BITS fixed point
+  // and the increment added per step. Steps are _stepLength mm apart along
+  // the path, so their number follows its length rather than any one axis.
+  int32_t _position[NUM_AXES];
+  int32_t _increment[NUM_AXES];
+  unsigned int _step;
+  unsigned int _steps;
+  float _stepLength;
+
+  // Velocity profile of the active move. Time is in seconds since the
+  // start of the block, the profile accelerates from the entry to the peak
+  // speed, cruises, then decelerates to the exit speed.
+  float _time;
+  float _entrySpeed;
+  float _peakSpeed;
+  float _exitSpeed;
+  float _accelTime;
+  float _cruiseTime;
+  float _decelTime;
+  float _accelDistance;
+  float _cruiseDistance;
+  float _profileTime;
+
+  /**
+   * Fetches the next block from the planner and sets up its execution.
+   * Blocks which complete instantly are released right away.
+   */
+  void startBlock()
+  {
+    while (_state == EXEC_IDLE && (_block = _planner->currentBlock()) != NULL)
+    {
+      beginBlock();
+    }
+  }
+
+  /**
+   * Sets up execution of the block just fetched.
+   */
+  void beginBlock()
+  {
+    switch (_block->type)
+    {
+    case BLOCK_RAPID:
+    case BLOCK_LINEAR:
+    case BLOCK_PARK:
+      if (!waitForPen())
+      {
+        beginMove();
+      }
+      break;
+
+    case BLOCK_DWELL:
+      _countdown = (unsigned long)(_block->target[0] * EXECUTOR_TICK_HZ);
+      _state = EXEC_DWELLING;
+      break;
+    }
+  }
+
+  /**
+   * Starts the move of the block, with the pen where it needs to be.
+   */
+  void beginMove()
+  {
+    if (_block->type == BLOCK_LINEAR)
+    {
+      startLine();
+      return;
+    }
+    if (_block->type == BLOCK_PARK)
+    {
+      // The pen is already up where the park leaves it.
+      _machine->park();
+    }
+    else
+    {
+      float *t = _block->target;
+      _machine->setPosition(t[0], t[1], t[2], t[3], t[4], t[5]);
+    }
+    _planner->discardCurrentBlock();
+  }
+
+  /**
+   * Sends the pen to a height, and starts counting the time it takes.
+   */
+  void sendPen(float z)
+  {
+    _penFrom = _penZ;
+    _penZ = z;
+    _penTicks = 0;
+    _machine->movePen(z);
+  }
+
+  /**
+   * Sends the pen to the block's height unless it already has been.
+   * @return the seconds the block must wait for the pen, if any.
+   */
+  float penWait()
+  {
+    float z = _block->target[2];
+    if (z != _penZ)
+    {
+      sendPen(z);
+    }
+    else if (_penTicks >= PEN_SETTLED_TICKS)
+    {
+      return 0;
+    }
+
+    // A rising pen only needs to be clear of the paper.
+    float height = (z > _penFrom) ? min(z, PEN_CLEARANCE) : z;
+    return _machine->penSeconds(_penFrom, z, height) - _penTicks * TICK_SECONDS;
+  }
+
+  /**
+   * Sends the pen to the block's height and waits for it before the move.
+   * @return true if the executor waits for the pen first.
+   */
+  boolean waitForPen()
+  {
+    float wait = penWait();
+    if (wait <= 0)
+    {
+      return false;
+    }
+    _countdown = (unsigned long)ceil(wait * EXECUTOR_TICK_HZ);
+    _state = EXEC_PEN;
+    return true;
+  }
+
+  /**
+   * Sends the pen towards the next block's height while this block ends,
+   * as late as lets the pen reach the paper, or PEN_CLEARANCE above it, no
+   * sooner than the block ends at the current rate. The block lands on its
+   * target at a whole tick, so a tick is allowed for that.
+   */
+  void sendPenEarly()
+  {
+    MotionBlock *next = _planner->nextBlock();
+    if (next == NULL || next->type == BLOCK_DWELL || next->target[2] == _penZ ||
+        (_penZ > 0 && _penZ < PEN_CLEARANCE))
+    {
+      return;
+    }
+    float boundary = (_penZ <= 0) ? 0 : PEN_CLEARANCE;
+    float lead = _machine->penSeconds(_penZ, next->target[2], boundary);
+    if (lead > 0 && _profileTime - _time <= (lead - TICK_SECONDS) * _rate)
+    {
+      sendPen(next->target[2]);
+    }
+  }
+
+  /**
+   * Computes the velocity profile of a linear move. If there is not enough
+   * room to reach the nominal speed the cruise phase is dropped and the
+   * profile peaks where the ramps meet.
+   */
+  void startLine()
+  {
+    float start[NUM_AXES] = { _machine->getX(), _machine->getY(), _machine->getZ(),
+                              _machine->getA(), _machine->getB(), _machine->getC() };
+    float length = _block->millimeters;
+    _steps = max(1, (unsigned int)ceil(length / STEP_SIZE));
+    _stepLength = length / _steps;
+    _step = 0;
+    for (int i = 0; i < NUM_AXES; i++)
+    {
+      _position[i] = lround(start[i] * DDA_ONE);
+      _increment[i] = (lround(_block->target[i] * DDA_ONE) - _position[i]) / (int32_t)_steps;
+    }
+    float *t = _block->target;
+    _machine->beginLine(t[0], t[1], t[2], t[3], t[4], t[5]);
+
+    float accel = _block->acceleration;
+    _entrySpeed = _block->entrySpeed;
+    _exitSpeed = _planner->beginCurrentBlock();
+    _peakSpeed = _block->nominalSpeed;
+
+    float entrySq = _entrySpeed * _entrySpeed;
+    float exitSq = _exitSpeed * _exitSpeed;
+    _accelDistance = (_peakSpeed * _peakSpeed - entrySq) / (2 * accel);
+    float decelDistance = (_peakSpeed * _peakSpeed - exitSq) / (2 * accel);
+    if (_accelDistance + decelDistance > length)
+    {
+      _peakSpeed = sqrt(accel * length + (entrySq + exitSq) / 2);
+      _peakSpeed = max(_peakSpeed, max(_entrySpeed, _exitSpeed));
+      _accelDistance = (_peakSpeed * _peakSpeed - entrySq) / (2 * accel);
+      decelDistance = (_peakSpeed * _peakSpeed - exitSq) / (2 * accel);
+    }
+    _cruiseDistance = max(length - _accelDistance - decelDistance, 0);
+
+    _accelTime = (_peakSpeed - _entrySpeed) / accel;
+    _decelTime = (_peakSpeed - _exitSpeed) / accel;
+    _cruiseTime = (_peakSpeed > 0) ? _cruiseDistance / _peakSpeed : 0;
+    _profileTime = _accelTime + _cruiseTime + _decelTime;
+    _state = EXEC_MOVING;
+  }
+
+  /**
+   * Eases the rate towards its target, changing the tool's speed along the
+   * active move by at most the block's acceleration. Without a move the
+   * rate can change at once.
+   */
+  void updateRate()
+  {
+    boolean waiting = _state == EXEC_MOVING && _countdown > 0;
+    float target = (_hold || waiting) ? 0 : _override * 0.01;
+    if (_rate == target)
+    {
+      return;
+    }
+
+    float change = target - _rate;
+    if (_state == EXEC_MOVING)
+    {
+      float speed = speedAt(_time);
+      if (speed > 0)
+      {
+        float limit = _block->acceleration * TICK_SECONDS / speed;
+        change = constrain(change, -limit, limit);
+      }
+    }
+    _rate += change;
+    if (fabs(_rate - target) < 1E-6)
+    {
+      _rate = target;
+    }
+  }
+
+  /**
+   * Returns the planned speed after a number of seconds into the block.
+   */
+  float speedAt(float time)
+  {
+    if (time < _accelTime)
+    {
+      return rampSpeed(_entrySpeed, _peakSpeed, _accelTime, time);
+    }
+
+    time -= _accelTime;
+    if (time < _cruiseTime)
+    {
+      return _peakSpeed;
+    }
+
+    time -= _cruiseTime;
+    return rampSpeed(_peakSpeed, _exitSpeed, _decelTime, time);
+  }
+
+  /**
+   * Speed reached while ramping, with the arguments of rampDistance.
+   */
+  float rampSpeed(float from, float to, float duration, float time)
+  {
+#ifdef S_CURVE_ACCELERATION
+    float u = time / duration;
+    return from + (to - from) * u * u * (3 - 2 * u);
+#else
+    return from + (to - from) * time / duration;
+#endif
+  }
+
+  /**
+   * Returns the distance covered after a number of seconds into the block.
+   */
+  float distanceAt(float time)
+  {
+    if (time < _accelTime)
+    {
+      return rampDistance(_entrySpeed, _peakSpeed, _accelTime, time);
+    }
+
+    time -= _accelTime;
+    if (time < _cruiseTime)
+    {
+      return _accelDistance + _peakSpeed * time;
+    }
+
+    time -= _cruiseTime;
+    return _accelDistance + _cruiseDistance + rampDistance(_peakSpeed, _exitSpeed, _decelTime, time);
+  }
+
+  /**
+   * Distance covered while ramping from one speed to another.
+   * @param from - speed at the start of the ramp.
+   * @param to - speed at the end of the ramp.
+   * @param duration - length of the ramp in seconds.
+   * @param time - seconds into the ramp.
+   */
+  float rampDistance(float from, float to, float duration, float time)
+  {
+#ifdef S_CURVE_ACCELERATION
+    // Speed follows smoothstep, 3u^2 - 2u^3, whose integral is u^3 - u^4/2.
+    float u = time / duration;
+    return from * time + (to - from) * duration * u * u * u * (1 - u / 2);
+#else
+    return from * time + (to - from) * time * time / (2 * duration);
+#endif
+  }
+
+  /**
+   * Steps the position along the active move and sends it to the machine.
+   * Each step only adds the increments, so no multiplies are needed.
+   * @param step - the step to advance to.
+   */
+  void advance(unsigned int step)
+  {
+    while (_step < step)
+    {
+      for (int i = 0; i < NUM_AXES; i++)
+      {
+        _position[i] += _increment[i];
+      }
+      _step++;
+    }
+
+    const float scale = 1.0 / DDA_ONE;
+    _machine->setPosition(_position[0] * scale, _position[1] * scale, _position[2] * scale,
+                          _position[3] * scale, _position[4] * scale, _position[5] * scale);
+  }
+};
+
+#endif  // Executor_H
+
+//------------------------------------------------------------------------------
+// Copyright (C) 2015 Martin Heermance (mheermance@gmail.com)
+/*
+┌──────────────────────────────────────────────────────────────────────────┐
+│                                                   TERMS OF USE: MIT License                                                   │
+├──────────────────────────────────────────────────────────────────────────┤
+│Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation     │
+│files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,     │
+│modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software │
+│is furnished to do so, subject to the following conditions:                                                                    │
+│                                                                                                                               │
+│The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. │
+│                                                                                                                               │
+│THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE           │
+│WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR          │
+│COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,    │
+│ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                          │
+└──────────────────────────────────────────────────────────────────────────┘
+*/
+
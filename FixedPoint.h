@@ -0,0 +1,207 @@
+//------------------------------------------------------------------------------
+// Fixed point helpers used by the integer inverse kinematics. The ATmega has
+// no floating point unit, so sqrt, atan2 and acos cost thousands of cycles in
+// soft float. These versions use only shifts, adds and 32-bit multiplies.
+//------------------------------------------------------------------------------
+// Copyright at end of file.
+
+#ifndef FixedPoint_H
+#define FixedPoint_H
+
+// Angles are radians scaled by 2^16.
+#define FIXED_ANGLE_BITS 16
+#define FIXED_PI 205887L
+#define FIXED_HALF_PI 102944L
+#define FIXED_TWO_PI 411775L
+
+// Reciprocal of the CORDIC gain, scaled by 2^16.
+#define CORDIC_INV_GAIN 39797L
+#define CORDIC_ITERATIONS 16
+
+// atan(2^-i) scaled by 2^16.
+const int32_t CORDIC_ATAN[CORDIC_ITERATIONS] PROGMEM =
+{
+  51472, 30386, 16055, 8150, 4091, 2047, 1024, 512,
+  256, 128, 64, 32, 16, 8, 4, 2
+};
+
+/**
+ * fixedToRadians - converts a fixed point angle to floating point radians.
+ */
+inline float fixedToRadians(int32_t angle)
+{
+  return angle * (1.0 / (1L << FIXED_ANGLE_BITS));
+}
+
+/**
+ * fixedSqrt - integer square root, rounded down.
+ * @param n - the value to take the root of.
+ */
+inline uint16_t fixedSqrt(uint32_t n)
+{
+  uint32_t root = 0;
+  uint32_t bit = 1UL << 30;
+
+  while (bit > n)
+  {
+    bit >>= 2;
+  }
+
+  while (bit != 0)
+  {
+    if (n >= root + bit)
+    {
+      n -= root + bit;
+      root = (root >> 1) + bit;
+    }
+    else
+    {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return root;
+}
+
+/**
+ * fixedBitLength - number of bits needed to hold a non-negative value.
+ */
+inline byte fixedBitLength(uint32_t n)
+{
+  byte bits = 0;
+  while (n != 0)
+  {
+    n >>= 1;
+    bits++;
+  }
+  return bits;
+}
+
+/**
+ * fixedAtan2 - computes the angle of a vector using CORDIC vectoring, which
+ * rotates the vector onto the X axis by successively smaller known angles.
+ * The result is within 1.5e-4 radians of atan2.
+ * @param y - vertical component, magnitude below 2^28.
+ * @param x - horizontal component, magnitude below 2^28.
+ * @param length - if not NULL receives the vector length, within one unit.
+ *   The length is only valid for vectors shorter than 2^15.
+ * @return the angle in fixed point radians between -PI and PI.
+ */
+inline int32_t fixedAtan2(int32_t y, int32_t x, int32_t *length)
+{
+  int32_t angle = 0;
+
+  // CORDIC converges for vectors right of the Y axis, so rotate others
+  // by a right angle first.
+  if (x < 0)
+  {
+    int32_t t = x;
+    if (y >= 0)
+    {
+      x = y;
+      y = -t;
+      angle = FIXED_HALF_PI;
+    }
+    else
+    {
+      x = -y;
+      y = t;
+      angle = -FIXED_HALF_PI;
+    }
+  }
+
+  // Scale the vector up so the shifts below keep their precision. The
+  // headroom left covers the CORDIC gain.
+  byte shift = 0;
+  if (x != 0 || y != 0)
+  {
+    while (x < (1L << 27) && y < (1L << 27) && y > -(1L << 27))
+    {
+      x <<= 1;
+      y <<= 1;
+      shift++;
+    }
+  }
+
+  for (byte i = 0; i < CORDIC_ITERATIONS; i++)
+  {
+    int32_t dx = y >> i;
+    int32_t dy = x >> i;
+    int32_t da = pgm_read_dword(&CORDIC_ATAN[i]);
+    if (y > 0)
+    {
+      x += dx;
+      y -= dy;
+      angle += da;
+    }
+    else
+    {
+      x -= dx;
+      y += dy;
+      angle -= da;
+    }
+  }
+
+  if (length != NULL)
+  {
+    *length = ((x >> shift) * CORDIC_INV_GAIN) >> 16;
+  }
+  return angle;
+}
+
+/**
+ * fixedAcos2 - computes acos(adjacent / hypotenuse) without dividing, as the
+ * angle of the vector (adjacent, sqrt(hypotenuse^2 - adjacent^2)).
+ * @param adjacent - signed side adjacent to the angle.
+ * @param hypotenuse - length of the hypotenuse, below 2^27.
+ * @param angle - receives the fixed point angle between 0 and PI.
+ * @return false if |adjacent| > hypotenuse so there is no solution.
+ */
+inline boolean fixedAcos2(int32_t adjacent, int32_t hypotenuse, int32_t *angle)
+{
+  int32_t difference = hypotenuse - adjacent;
+  int32_t sum = hypotenuse + adjacent;
+  if (difference < 0 || sum < 0)
+  {
+    return false;
+  }
+
+  // Scale down until the product of the factors fits in 32 bits. atan2
+  // only depends on the ratio of its arguments so the scale is free, and
+  // a small factor near full extension keeps as many bits as possible.
+  byte bits = fixedBitLength(sum) + fixedBitLength(difference);
+  if (bits > 32)
+  {
+    byte shift = (bits - 31) / 2;
+    sum >>= shift;
+    difference >>= shift;
+    adjacent >>= shift;
+  }
+
+  int32_t opposite = fixedSqrt((uint32_t)difference * sum);
+  *angle = fixedAtan2(opposite, adjacent, NULL);
+  return true;
+}
+
+#endif  // FixedPoint_H
+
+//------------------------------------------------------------------------------
+// Copyright (C) 2015 Martin Heermance (mheermance@gmail.com)
+/*
+┌──────────────────────────────────────────────────────────────────────────┐
+│                                                   TERMS OF USE: MIT License                                                   │
+├──────────────────────────────────────────────────────────────────────────┤
+│Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation     │
+│files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,     │
+│modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software │
+│is furnished to do so, subject to the following conditions:                                                                    │
+│                                                                                                                               │
+│The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. │
+│                                                                                                                               │
+│THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE           │
+│WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR          │
+│COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,    │
+│ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                          │
+└──────────────────────────────────────────────────────────────────────────┘
+*/
+
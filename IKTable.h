@@ -0,0 +1,294 @@
+//------------------------------------------------------------------------------
+// Inverse kinematics grid for a 103 mm humerus and 100 mm ulna, generated by
+// tools/IKTableGenerator.cpp. Do not edit, regenerate it instead.
+// Worst error of the interpolated cells is 0.00200 radians.
+//------------------------------------------------------------------------------
+
+#ifndef IKTable_H
+#define IKTable_H
+
+#define IK_TABLE_HUMERUS 103
+#define IK_TABLE_ULNA 100
+#define IK_TABLE_X_MIN -204
+#define IK_TABLE_SPACING_BITS 3
+#define IK_TABLE_COLUMNS 52
+#define IK_TABLE_ROWS 27
+#define IK_TABLE_ANGLE_SCALE 8192
+#define IK_TABLE_ERROR 0.00200
+
+const int16_t IK_SHOULDER_TABLE[IK_TABLE_ROWS * IK_TABLE_COLUMNS] PROGMEM =
+{
+  0, 23611, 22616, 21861, 21224, 20661, 20148, 19673, 19228, 18808, 18407, 18023,
+  17655, 17300, 16958, 16627, 16309, 16004, 15715, 15444, 15199, 14996, 14866, 14895,
+  15404, 19921, -5815, -10332, -10841, -10870, -10740, -10536, -10292, -10021, -9732, -9427,
+  -9109, -8778, -8436, -8081, -7713, -7329, -6928, -6508, -6063, -5588, -5075, -4512,
+  -3875, -3120, -2125, 0, 0, 23302, 22285, 21513, 20857, 20274, 19741, 19243,
+  18773, 18324, 17892, 17472, 17063, 16660, 16262, 15865, 15466, 15062, 14647, 14213,
+  13747, 13224, 12598, 11752, 10333, 6938, -659, -5769, -7750, -8578, -8929, -9042,
+  -9022, -8917, -8755, -8551, -8315, -8053, -7768, -7462, -7136, -6789, -6420, -6028,
+  -5608, -5156, -4663, -4117, -3496, -2754, -1766, 0, 0, 23045, 21993, 21196,
+  20520, 19916, 19361, 18841, 18346, 17869, 17406, 16952, 16503, 16056, 15605, 15147,
+  14675, 14181, 13654, 13078, 12425, 11650, 10670, 9324, 7298, 4156, 142, -3245,
+  -5357, -6560, -7234, -7597, -7768, -7812, -7769, -7662, -7505, -7310, -7081, -6823,
+  -6538, -6227, -5891, -5526, -5131, -4700, -4226, -3696, -3087, -2352, -1356, 0,
+  0, 22849, 21740, 20914, 20214, 19588, 19011, 18468, 17949, 17446, 16954, 16468,
+  15983, 15495, 14997, 14485, 13949, 13380, 12763, 12078, 11293, 10362, 9211, 7730,
+  5787, 3335, 629, -1809, -3653, -4915, -5740, -6262, -6574, -6739, -6797, -6775,
+  -6692, -6558, -6382, -6170, -5925, -5649, -5343, -5006, -4634, -4224, -3767, -3250,
+  -2650, -1915, -891, 0, 0, 22726, 21533, 20669, 19942, 19293, 18693, 18128,
+  17585, 17058, 16539, 16024, 15507, 14983, 14445, 13887, 13300, 12673, 11991, 11233,
+  10372, 9370, 8179, 6744, 5029, 3074, 1036, -849, -2408, -3598, -4461, -5062,
+  -5465, -5718, -5856, -5906, -5885, -5806, -5679, -5509, -5302, -5059, -4782, -4469,
+  -4119, -3728, -3286, -2780, -2184, -1441, -358, 0, 0, 22707, 21376, 20465,
+  19707, 19032, 18410, 17822, 17257, 16707, 16164, 15623, 15079, 14524, 13954, 13361,
+  12735, 12067, 11342, 10544, 9652, 8639, 7478, 6150, 4657, 3045, 1412, -118,
+  -1446, -2528, -3368, -3996, -4449, -4760, -4957, -5063, -5094, -5062, -4977, -4846,
+  -4672, -4459, -4208, -3919, -3589, -3213, -2784, -2285, -1688, -925, 269, 0,
+  0, 22887, 21281, 20306, 19511, 18809, 18163, 17554, 16967, 16396, 15832, 15268,
+  14700, 14122, 13526, 12906, 12255, 11561, 10814, 10002, 9108, 8118, 7020, 5810,
+  4502, 3136, 1774, 489, -658, -1632, -2425, -3048, -3521, -3867, -4104, -4252,
+  -4324, -4331, -4282, -4183, -4039, -3853, -3626, -3357, -3044, -2682, -2262, -1766,
+  -1160, -359, 1086, 0, 0, 0, 21264, 20199, 19359, 18626, 17955, 17324,
+  16718, 16127, 15543, 14961, 14374, 13776, 13162, 12525, 11857, 11151, 10398, 9588,
+  8713, 7764, 6737, 5638, 4481, 3297, 2129, 1023, 18, -859, -1597, -2198,
+  -2673, -3035, -3298, -3475, -3577, -3615, -3596, -3524, -3406, -3243, -3036, -2784,
+  -2485, -2134, -1719, -1220, -595, 272, 0, 0, 0, 0, 21364, 20154,
+  19257, 18487, 17789, 17136, 16510, 15901, 15300, 14702, 14100, 13488, 12861, 12214,
+  11538, 10830, 10081, 9287, 8440, 7539, 6584, 5582, 4548, 3505, 2483, 1512,
+  620, -173, -856, -1427, -1892, -2258, -2534, -2730, -2855, -2916, -2920, -2871,
+  -2773, -2629, -2439, -2201, -1913, -1568, -1153, -643, 16, 1004, 0, 0,
+  0, 0, 21699, 20189, 19210, 18397, 17668, 16991, 16345, 15719, 15104, 14492,
+  13879, 13257, 12622, 11970, 11294, 10590, 9854, 9081, 8268, 7417, 6529, 5611,
+  4678, 3746, 2837, 1972, 1172, 452, -180, -719, -1167, -1529, -1810, -2017,
+  -2156, -2234, -2255, -2224, -2142, -2013, -1835, -1608, -1327, -983, -561, -30,
+  688, 1956, 0, 0, 0, 0, 0, 20339, 19233, 18361, 17596, 16892,
+  16226, 15584, 14955, 14332, 13709, 13081, 12442, 11789, 11117, 10423, 9703, 8956,
+  8180, 7376, 6548, 5704, 4854, 4012, 3193, 2415, 1690, 1032, 448, -59,
+  -487, -840, -1119, -1331, -1478, -1567, -1600, -1581, -1512, -1394, -1225, -1004,
+  -725, -376, 61, 630, 1456, 0, 0, 0, 0, 0, 0, 20708,
+  19345, 18389, 17578, 16844, 16155, 15496, 14854, 14221, 13590, 12958, 12318, 11668,
+  11004, 10323, 9622, 8901, 8160, 7401, 6628, 5847, 5067, 4299, 3555, 2846,
+  2185, 1581, 1039, 564, 157, -183, -456, -667, -819, -914, -954, -944,
+  -882, -770, -606, -386, -103, 257, 722, 1358, 2422, 0, 0, 0,
+  0, 0, 0, 0, 19595, 18499, 17623, 16850, 16136, 15457, 14802, 14159,
+  13523, 12887, 12249, 11604, 10949, 10282, 9601, 8907, 8200, 7482, 6757, 6030,
+  5310, 4604, 3922, 3273, 2665, 2107, 1604, 1159, 774, 449, 184, -23,
+  -174, -270, -315, -308, -250, -141, 24, 248, 542, 926, 1440, 2200,
+  0, 0, 0, 0, 0, 0, 0, 0, 20146, 18721, 17746, 16920,
+  16172, 15472, 14801, 14148, 13506, 12868, 12232, 11592, 10947, 10295, 9635, 8967,
+  8291, 7610, 6928, 6249, 5580, 4926, 4296, 3697, 3136, 2619, 2150, 1733,
+  1370, 1062, 808, 608, 461, 366, 322, 329, 387, 499, 669, 904,
+  1220, 1644, 2245, 3320, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 19143, 17972, 17066, 16273, 15544, 14854, 14189, 13540, 12900, 12265, 11632,
+  10997, 10360, 9719, 9074, 8428, 7781, 7136, 6499, 5873, 5265, 4680, 4125,
+  3604, 3123, 2685, 2295, 1953, 1661, 1420, 1229, 1089, 999, 959, 970,
+  1033, 1153, 1336, 1592, 1944, 2438, 3224, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 18367, 17313, 16451, 15682, 14966, 14285,
+  13627, 12984, 12350, 11722, 11096, 10473, 9850, 9227, 8607, 7990, 7379, 6778,
+  6190, 5621, 5075, 4557, 4072, 3623, 3214, 2849, 2528, 2253, 2026, 1847,
+  1716, 1633, 1601, 1621, 1695, 1830, 2034, 2325, 2740, 3374, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 19226, 17720,
+  16732, 15899, 15147, 14443, 13772, 13122, 12486, 11862, 11244, 10632, 10025, 9423,
+  8826, 8235, 7654, 7085, 6531, 5996, 5484, 4999, 4545, 4126, 3743, 3401,
+  3100, 2844, 2632, 2466, 2347, 2276, 2256, 2289, 2380, 2539, 2779, 3131,
+  3667, 4748, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 18513, 17174, 16224, 15412, 14673, 13980, 13318, 12678, 12054,
+  11442, 10840, 10246, 9661, 9084, 8517, 7962, 7421, 6896, 6391, 5910, 5454,
+  5028, 4635, 4278, 3958, 3677, 3439, 3243, 3093, 2989, 2933, 2930, 2984,
+  3102, 3299, 3601, 4069, 4953, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 18008, 16723, 15793, 14993,
+  14265, 13582, 12931, 12303, 11693, 11097, 10514, 9943, 9384, 8837, 8304, 7787,
+  7288, 6810, 6355, 5926, 5526, 5158, 4823, 4525, 4265, 4046, 3869, 3736,
+  3651, 3616, 3637, 3722, 3883, 4145, 4567, 5370, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 17686, 16374, 15445, 14651, 13930, 13257, 12618, 12004, 11410, 10833, 10273,
+  9728, 9198, 8684, 8188, 7712, 7257, 6826, 6421, 6045, 5700, 5387, 5111,
+  4872, 4674, 4518, 4407, 4346, 4340, 4396, 4529, 4765, 5162, 5969, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 17662, 16146, 15194, 14396, 13680, 13015,
+  12387, 11788, 11213, 10658, 10122, 9606, 9108, 8630, 8173, 7739, 7329, 6946,
+  6592, 6269, 5980, 5726, 5510, 5335, 5204, 5122, 5094, 5130, 5244, 5466,
+  5868, 6859, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  16096, 15068, 14249, 13528, 12868, 12252, 11668, 11112, 10580, 10072, 9586, 9122,
+  8681, 8265, 7875, 7513, 7180, 6880, 6613, 6384, 6194, 6048, 5950, 5908,
+  5932, 6040, 6271, 6735, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 16493, 15130, 14246, 13504, 12841, 12230, 11660,
+  11123, 10616, 10135, 9681, 9254, 8853, 8481, 8139, 7828, 7550, 7310, 7110,
+  6953, 6847, 6800, 6825, 6950, 7238, 8028, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 15690,
+  14488, 13668, 12977, 12361, 11798, 11277, 10793, 10341, 9922, 9534, 9177, 8855,
+  8568, 8319, 8112, 7953, 7848, 7812, 7868, 8070, 8674, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 14261, 13413, 12743, 12164, 11647, 11180,
+  10758, 10376, 10035, 9735, 9480, 9274, 9127, 9052, 9080, 9298, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 13186, 12550, 12056, 11652, 11324, 11074, 10917, 10907, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+const int16_t IK_ELBOW_TABLE[IK_TABLE_ROWS * IK_TABLE_COLUMNS] PROGMEM =
+{
+  0, 4316, 6339, 7876, 9175, 10327, 11378, 12353, 13269, 14140, 14972, 15773,
+  16548, 17300, 18033, 18750, 19453, 20145, 20826, 21498, 22164, 22825, 23482, 24137,
+  24798, 25522, 25522, 24798, 24137, 23482, 22825, 22164, 21498, 20826, 20145, 19453,
+  18750, 18033, 17300, 16548, 15773, 14972, 14140, 13269, 12353, 11378, 10327, 9175,
+  7876, 6339, 4316, 0, 0, 4265, 6302, 7845, 9147, 10301, 11352, 12327,
+  13244, 14114, 14946, 15746, 16519, 17270, 18002, 18716, 19417, 20104, 20781, 21447,
+  22105, 22753, 23390, 24011, 24596, 25056, 25056, 24596, 24011, 23390, 22753, 22105,
+  21447, 20781, 20104, 19417, 18716, 18002, 17270, 16519, 15746, 14946, 14114, 13244,
+  12327, 11352, 10301, 9147, 7845, 6302, 4265, 0, 0, 4109, 6192, 7751,
+  9062, 10220, 11274, 12251, 13167, 14037, 14867, 15665, 16435, 17182, 17908, 18616,
+  19308, 19985, 20648, 21297, 21930, 22545, 23133, 23677, 24137, 24426, 24426, 24137,
+  23677, 23133, 22545, 21930, 21297, 20648, 19985, 19308, 18616, 17908, 17182, 16435,
+  15665, 14867, 14037, 13167, 12251, 11274, 10220, 9062, 7751, 6192, 4109, 0,
+  0, 3836, 6004, 7593, 8919, 10086, 11144, 12123, 13040, 13908, 14736, 15530,
+  16295, 17035, 17753, 18451, 19130, 19791, 20433, 21056, 21656, 22225, 22753, 23216,
+  23577, 23782, 23782, 23577, 23216, 22753, 22225, 21656, 21056, 20433, 19791, 19130,
+  18451, 17753, 17035, 16295, 15530, 14736, 13908, 13040, 12123, 11144, 10086, 8919,
+  7593, 6004, 3836, 0, 0, 3420, 5732, 7368, 8716, 9896, 10961, 11944,
+  12862, 13729, 14554, 15343, 16101, 16833, 17540, 18224, 18886, 19527, 20145, 20736,
+  21297, 21818, 22287, 22682, 22975, 23133, 23133, 22975, 22682, 22287, 21818, 21297,
+  20736, 20145, 19527, 18886, 18224, 17540, 16833, 16101, 15343, 14554, 13729, 12862,
+  11944, 10961, 9896, 8716, 7368, 5732, 3420, 0, 0, 2802, 5367, 7071,
+  8452, 9649, 10725, 11713, 12633, 13499, 14320, 15104, 15855, 16576, 17270, 17939,
+  18583, 19201, 19791, 20349, 20871, 21347, 21763, 22105, 22350, 22479, 22479, 22350,
+  22105, 21763, 21347, 20871, 20349, 19791, 19201, 18583, 17939, 17270, 16576, 15855,
+  15104, 14320, 13499, 12633, 11713, 10725, 9649, 8452, 7071, 5367, 2802, 0,
+  0, 1788, 4889, 6695, 8121, 9344, 10434, 11429, 12353, 13218, 14037, 14815,
+  15557, 16267, 16948, 17600, 18224, 18818, 19380, 19907, 20391, 20826, 21199, 21498,
+  21709, 21818, 21818, 21709, 21498, 21199, 20826, 20391, 19907, 19380, 18818, 18224,
+  17600, 16948, 16267, 15557, 14815, 14037, 13218, 12353, 11429, 10434, 9344, 8121,
+  6695, 4889, 1788, 0, 0, 0, 4265, 6229, 7719, 8976, 10086, 11092,
+  12021, 12887, 13703, 14476, 15210, 15909, 16576, 17211, 17815, 18385, 18921, 19417,
+  19868, 20267, 20604, 20871, 21056, 21151, 21151, 21056, 20871, 20604, 20267, 19868,
+  19417, 18921, 18385, 17815, 17211, 16576, 15909, 15210, 14476, 13703, 12887, 12021,
+  11092, 10086, 8976, 7719, 6229, 4265, 0, 0, 0, 0, 3420, 5653,
+  7237, 8540, 9677, 10699, 11636, 12506, 13320, 14088, 14815, 15503, 16156, 16775,
+  17359, 17908, 18418, 18886, 19308, 19677, 19985, 20226, 20391, 20476, 20476, 20391,
+  20226, 19985, 19677, 19308, 18886, 18418, 17908, 17359, 16775, 16156, 15503, 14815,
+  14088, 13320, 12506, 11636, 10699, 9677, 8540, 7237, 5653, 3420, 0, 0,
+  0, 0, 2112, 4934, 6660, 8030, 9203, 10247, 11196, 12072, 12887, 13652,
+  14372, 15051, 15692, 16295, 16861, 17389, 17877, 18320, 18716, 19060, 19344, 19564,
+  19714, 19791, 19791, 19714, 19564, 19344, 19060, 18716, 18320, 17877, 17389, 16861,
+  16295, 15692, 15051, 14372, 13652, 12887, 12072, 11196, 10247, 9203, 8030, 6660,
+  4934, 2112, 0, 0, 0, 0, 0, 4001, 5966, 7433, 8658, 9732,
+  10699, 11584, 12404, 13167, 13883, 14554, 15183, 15773, 16323, 16833, 17300, 17722,
+  18096, 18418, 18683, 18886, 19025, 19095, 19095, 19025, 18886, 18683, 18418, 18096,
+  17722, 17300, 16833, 16323, 15773, 15183, 14554, 13883, 13167, 12404, 11584, 10699,
+  9732, 8658, 7433, 5966, 4001, 0, 0, 0, 0, 0, 0, 2646,
+  5111, 6730, 8030, 9147, 10139, 11040, 11867, 12633, 13346, 14011, 14632, 15210,
+  15746, 16240, 16689, 17094, 17449, 17753, 18002, 18192, 18320, 18385, 18385, 18320,
+  18192, 18002, 17753, 17449, 17094, 16689, 16240, 15746, 15210, 14632, 14011, 13346,
+  12633, 11867, 11040, 10139, 9147, 8030, 6730, 5111, 2646, 0, 0, 0,
+  0, 0, 0, 0, 4001, 5889, 7303, 8481, 9511, 10434, 11274, 12046,
+  12760, 13422, 14037, 14606, 15130, 15611, 16046, 16435, 16775, 17064, 17300, 17479,
+  17600, 17661, 17661, 17600, 17479, 17300, 17064, 16775, 16435, 16046, 15611, 15130,
+  14606, 14037, 13422, 12760, 12046, 11274, 10434, 9511, 8481, 7303, 5889, 4001,
+  0, 0, 0, 0, 0, 0, 0, 0, 2303, 4844, 6447, 7719,
+  8803, 9759, 10620, 11404, 12123, 12786, 13397, 13960, 14476, 14946, 15369, 15746,
+  16074, 16351, 16576, 16747, 16861, 16919, 16919, 16861, 16747, 16576, 16351, 16074,
+  15746, 15369, 14946, 14476, 13960, 13397, 12786, 12123, 11404, 10620, 9759, 8803,
+  7719, 6447, 4844, 2303, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 3420, 5409, 6833, 7999, 9005, 9896, 10699, 11429, 12097, 12709, 13269,
+  13780, 14243, 14658, 15025, 15343, 15611, 15827, 15991, 16101, 16156, 16156, 16101,
+  15991, 15827, 15611, 15343, 15025, 14658, 14243, 13780, 13269, 12709, 12097, 11429,
+  10699, 9896, 9005, 7999, 6833, 5409, 3420, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 4055, 5772, 7071, 8152, 9090, 9923,
+  10672, 11352, 11969, 12531, 13040, 13499, 13908, 14269, 14580, 14841, 15051, 15210,
+  15316, 15369, 15369, 15316, 15210, 15051, 14841, 14580, 14269, 13908, 13499, 13040,
+  12531, 11969, 11352, 10672, 9923, 9090, 8152, 7071, 5772, 4055, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1788, 4416,
+  5966, 7171, 8182, 9062, 9841, 10540, 11170, 11739, 12251, 12709, 13117, 13473,
+  13780, 14037, 14243, 14398, 14502, 14554, 14554, 14502, 14398, 14243, 14037, 13780,
+  13473, 13117, 12709, 12251, 11739, 11170, 10540, 9841, 9062, 8182, 7171, 5966,
+  4416, 1788, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 2303, 4562, 6004, 7138, 8091, 8919, 9649, 10301, 10883,
+  11404, 11867, 12276, 12633, 12938, 13193, 13397, 13550, 13652, 13703, 13703, 13652,
+  13550, 13397, 13193, 12938, 12633, 12276, 11867, 11404, 10883, 10301, 9649, 8919,
+  8091, 7138, 6004, 4562, 2303, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 2393, 4514, 5889, 6970,
+  7876, 8658, 9344, 9950, 10487, 10961, 11378, 11739, 12046, 12302, 12506, 12658,
+  12760, 12811, 12811, 12760, 12658, 12506, 12302, 12046, 11739, 11378, 10961, 10487,
+  9950, 9344, 8658, 7876, 6970, 5889, 4514, 2393, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 2112, 4265, 5613, 6660, 7529, 8273, 8919, 9483, 9977, 10407, 10778,
+  11092, 11352, 11558, 11713, 11816, 11867, 11867, 11816, 11713, 11558, 11352, 11092,
+  10778, 10407, 9977, 9483, 8919, 8273, 7529, 6660, 5613, 4265, 2112, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 1233, 3779, 5154, 6192, 7037, 7751,
+  8363, 8890, 9344, 9732, 10059, 10327, 10540, 10699, 10804, 10857, 10857, 10804,
+  10699, 10540, 10327, 10059, 9732, 9344, 8890, 8363, 7751, 7037, 6192, 5154,
+  3779, 1233, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  2950, 4465, 5532, 6375, 7071, 7656, 8152, 8570, 8919, 9203, 9428, 9594,
+  9704, 9759, 9759, 9704, 9594, 9428, 9203, 8919, 8570, 8152, 7656, 7071,
+  6375, 5532, 4465, 2950, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 1233, 3420, 4610, 5491, 6192, 6765, 7237,
+  7625, 7938, 8182, 8363, 8481, 8540, 8540, 8481, 8363, 8182, 7938, 7625,
+  7237, 6765, 6192, 5491, 4610, 3420, 1233, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1393,
+  3226, 4265, 5023, 5613, 6079, 6447, 6730, 6936, 7071, 7138, 7138, 7071,
+  6936, 6730, 6447, 6079, 5613, 5023, 4265, 3226, 1393, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 2210, 3292, 4001, 4514, 4889, 5154,
+  5325, 5409, 5409, 5325, 5154, 4889, 4514, 4001, 3292, 2210, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 1667, 2303, 2646, 2802, 2802, 2646, 2303, 1667, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+// Two bits per cell holding its IK_CELL class, four cells per byte.
+const uint8_t IK_CELL_MASK[332] PROGMEM =
+{
+  0x55, 0xa5, 0xaa, 0xaa, 0xaa, 0x55, 0x55, 0x95, 0xaa, 0xaa, 0xaa, 0x56,
+  0x55, 0x55, 0xa9, 0xaa, 0xaa, 0x5a, 0x55, 0x55, 0x95, 0xaa, 0xaa, 0xaa,
+  0x55, 0x55, 0x55, 0xaa, 0xaa, 0xaa, 0x55, 0x55, 0x55, 0xa5, 0xaa, 0xaa,
+  0x6a, 0x55, 0x55, 0x95, 0xaa, 0xaa, 0x6a, 0x55, 0x55, 0x55, 0xa9, 0xaa,
+  0xaa, 0x5a, 0x55, 0x55, 0xa5, 0xaa, 0xaa, 0x5a, 0x55, 0x55, 0x55, 0xaa,
+  0xaa, 0xaa, 0x56, 0x55, 0x55, 0xa5, 0xaa, 0xaa, 0x56, 0x55, 0x56, 0x95,
+  0xaa, 0xaa, 0x6a, 0x55, 0x55, 0x55, 0xa9, 0xaa, 0xaa, 0x56, 0xa5, 0x56,
+  0xa5, 0xaa, 0xaa, 0x5a, 0x55, 0x51, 0x55, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+  0x56, 0xaa, 0xaa, 0xaa, 0x56, 0x15, 0x54, 0x55, 0xaa, 0xaa, 0xaa, 0xaa,
+  0xaa, 0xaa, 0xaa, 0xaa, 0x6a, 0x55, 0x05, 0x55, 0x95, 0xaa, 0xaa, 0xaa,
+  0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x5a, 0x55, 0x01, 0x55, 0x95, 0xaa, 0xaa,
+  0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x55, 0x15, 0x40, 0x55, 0xa5, 0xaa,
+  0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x6a, 0x55, 0x05, 0x40, 0x55, 0xa5,
+  0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x56, 0x55, 0x00, 0x50, 0x55,
+  0xa5, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x6a, 0x55, 0x15, 0x00, 0x50,
+  0x55, 0xa5, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x56, 0x55, 0x01, 0x00,
+  0x50, 0x55, 0xa5, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x6a, 0x55, 0x15, 0x00,
+  0x00, 0x54, 0x55, 0x95, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0x55, 0x55, 0x05,
+  0x00, 0x00, 0x54, 0x55, 0x95, 0xaa, 0xaa, 0xaa, 0xaa, 0x5a, 0x55, 0x55,
+  0x00, 0x00, 0x00, 0x54, 0x55, 0x55, 0xa9, 0xaa, 0xaa, 0x5a, 0x55, 0x55,
+  0x05, 0x00, 0x00, 0x00, 0x54, 0x55, 0x55, 0x55, 0xaa, 0x56, 0x55, 0x55,
+  0x55, 0x00, 0x00, 0x00, 0x00, 0x54, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+  0x55, 0x05, 0x00, 0x00, 0x00, 0x00, 0x50, 0x55, 0x55, 0x55, 0x55, 0x55,
+  0x55, 0x15, 0x00, 0x00, 0x00, 0x00, 0x00, 0x50, 0x55, 0x55, 0x55, 0x55,
+  0x55, 0x55, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x55, 0x55, 0x55,
+  0x55, 0x55, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x54, 0x55,
+  0x55, 0x55, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x55, 0x55, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+#endif  // IKTable_H
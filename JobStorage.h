@@ -0,0 +1,266 @@
+//------------------------------------------------------------------------------
+// JobStorage - keeps jobs on an SD card, so a long drawing can be uploaded
+// once and then run from the card, without waiting on the serial link and
+// to the end even if the host goes away.
+//
+// "$U=name" starts an upload: each following line is stored and answered
+// with "ok" until a line holding just "%". "$R=name" runs the job, whose
+// lines go through the parser as if they had been received, but only errors
+// are reported, as "[JOB LINE:n] error: ...". "[JOB DONE]" follows the
+// last line. Serial input other than realtime commands waits until then,
+// and a soft reset stops the job.
+//
+// The card is read a chunk at a time into one half of a double buffer while
+// the parser works through the other half. Reads happen from the main loop
+// while the parser waits for room in the planner, so they overlap the motion
+// rather than holding up the next line.
+//------------------------------------------------------------------------------
+// Copyright at end of file.
+
+#ifndef JobStorage_H
+#define JobStorage_H
+
+#include <SD.h>
+
+// Chip select pin of the card, 4 on the Ethernet shield and many SD shields.
+#ifndef JOB_CARD_SELECT
+#define JOB_CARD_SELECT 4
+#endif
+
+// Bytes read from the card at a time into each half of the buffer.
+#define JOB_CHUNK_SIZE 64
+
+class JobStorage
+{
+public:
+  JobStorage()
+  {
+    _present = false;
+    _playing = false;
+    _uploading = false;
+  }
+
+  /**
+   * begin - looks for the card.
+   * @return true if it is present.
+   */
+  boolean begin()
+  {
+    _present = SD.begin(JOB_CARD_SELECT);
+    return _present;
+  }
+
+  /**
+   * play - starts reading a job, with its first chunk read ahead.
+   * @return false if there is no card or no such job.
+   */
+  boolean play(const char *name)
+  {
+    stop();
+    if (!_present)
+    {
+      return false;
+    }
+    _file = SD.open(name, FILE_READ);
+    if (!_file)
+    {
+      return false;
+    }
+    _size = _file.size();
+    _length[0] = 0;
+    _length[1] = 0;
+    _current = 0;
+    _offset = 0;
+    _line = 0;
+    _lineStart = true;
+    _playing = true;
+    prefetch();
+    return true;
+  }
+
+  /**
+   * upload - starts replacing a job with the lines given to write.
+   * @return false if there is no card or the job cannot be created.
+   */
+  boolean upload(const char *name)
+  {
+    stop();
+    if (!_present)
+    {
+      return false;
+    }
+    // Files open for writing at their end.
+    SD.remove(name);
+    _file = SD.open(name, FILE_WRITE);
+    if (!_file)
+    {
+      return false;
+    }
+    _uploading = true;
+    return true;
+  }
+
+  /**
+   * write - adds a line to the job being uploaded.
+   * @return false if the card is full or failed.
+   */
+  boolean write(const char *line)
+  {
+    size_t length = strlen(line);
+    return _file.write((const uint8_t *)line, length) == length && _file.write('\n') == 1;
+  }
+
+  /**
+   * stop - closes the job being played or uploaded.
+   */
+  void stop()
+  {
+    if (_playing || _uploading)
+    {
+      _file.close();
+    }
+    _playing = false;
+    _uploading = false;
+  }
+
+  boolean isPlaying()
+  {
+    return _playing;
+  }
+
+  boolean isUploading()
+  {
+    return _uploading;
+  }
+
+  /**
+   * isFinished - true once every character of the playing job has been read.
+   */
+  boolean isFinished()
+  {
+    return _playing && available() == 0 && _file.available() == 0;
+  }
+
+  /**
+   * prefetch - reads the next chunk of the playing job if half the buffer
+   * is free. Called each pass of the main loop.
+   */
+  void prefetch()
+  {
+    byte spare = _current ^ 1;
+    if (!_playing || _length[spare] != 0 || _file.available() == 0)
+    {
+      return;
+    }
+    int length = _file.read(_chunks[spare], JOB_CHUNK_SIZE);
+    _length[spare] = max(length, 0);
+  }
+
+  /**
+   * available - the characters which can be read without waiting for the
+   * card.
+   */
+  int available()
+  {
+    int count = _length[_current] - _offset + _length[_current ^ 1];
+    // A last line without an end is given one.
+    if (count == 0 && !_lineStart && _file.available() == 0)
+    {
+      return 1;
+    }
+    return count;
+  }
+
+  /**
+   * read - the next character of the playing job.
+   * @return the character, or -1 if none is available.
+   */
+  int read()
+  {
+    if (_offset == _length[_current])
+    {
+      byte spare = _current ^ 1;
+      if (_length[spare] == 0)
+      {
+        if (_lineStart || _file.available() != 0)
+        {
+          return -1;
+        }
+        _lineStart = true;
+        return '\n';
+      }
+      _length[_current] = 0;
+      _current = spare;
+      _offset = 0;
+    }
+
+    char c = _chunks[_current][_offset++];
+    if (_lineStart)
+    {
+      _line++;
+    }
+    _lineStart = (c == '\n');
+    return c;
+  }
+
+  /**
+   * line - the number of the line being read, from 1.
+   */
+  unsigned int line()
+  {
+    return _line;
+  }
+
+  /**
+   * progress - how much of the playing job has been read, in percent.
+   */
+  byte progress()
+  {
+    if (_size == 0)
+    {
+      return 100;
+    }
+    int buffered = _length[_current] - _offset + _length[_current ^ 1];
+    return (_file.position() - buffered) * 100 / _size;
+  }
+
+private:
+  File _file;
+  boolean _present;
+  boolean _playing;
+  boolean _uploading;
+  uint32_t _size;
+
+  // The two halves of the buffer, the one being read and how far into it.
+  char _chunks[2][JOB_CHUNK_SIZE];
+  int _length[2];
+  byte _current;
+  int _offset;
+
+  // Lines begun, and whether the last character ended one.
+  unsigned int _line;
+  boolean _lineStart;
+};
+
+static JobStorage jobs;
+
+#endif  // JobStorage_H
+
+/*
+┌──────────────────────────────────────────────────────────────────────────┐
+│                                                   TERMS OF USE: MIT License                                                   │
+├──────────────────────────────────────────────────────────────────────────┤
+│Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation     │
+│files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,     │
+│modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software │
+│is furnished to do so, subject to the following conditions:                                                                    │
+│                                                                                                                               │
+│The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. │
+│                                                                                                                               │
+│THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE           │
+│WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR          │
+│COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,    │
+│ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                          │
+└──────────────────────────────────────────────────────────────────────────┘
+*/
+
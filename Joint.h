@@ -3,13 +3,42 @@
 
 #include <math.h>
 
+#ifdef PULSE_ENGINE
+#include "PulseEngine.h"
+#endif
+
 // float to int conversion with rounding
 #define fti(x) ((x) >= 0 ? (int)((x)+0.5) : (int)((x)-0.5)) 
 
+// Fractional bits of the pulse widths and table positions used by the
+// calibration lookup.
+#define CALIBRATION_FRACTION_BITS 8
+#define CALIBRATION_ONE (1L << CALIBRATION_FRACTION_BITS)
+
 // Defines and manages a single joint of the arm.
 class Joint
 {
   public:
+#ifdef PULSE_ENGINE
+    /*
+      setParameters : configures the joint to drive a channel of the pulse engine.
+      Parameters:
+        engine    the pulse engine generating the servo pulses.
+        channel   the engine channel attached to this joint's servo.
+        center    the pulse width which centers the joint.
+        widthPerRadian    the pulse width to radian ratio which is signed to handle inverted servos.
+     */
+    void setParameters(PulseEngine * engine, byte channel, int center, float widthPerRadian)
+    {
+      _center = center;
+      _widthPerRadian = widthPerRadian;
+      _engine = engine;
+      _channel = channel;
+      _table = NULL;
+      _maxVelocity = 0;
+      _maxAcceleration = 0;
+    }
+#else
     /*
       setParameters : configures the joint with a number of measure constants used to position the joint.
       Parameters:
@@ -22,6 +51,65 @@ class Joint
       _center = center;
       _widthPerRadian = widthPerRadian;
       _servo = servo;
+      _pulseWidth = -1;
+      _table = NULL;
+      _maxVelocity = 0;
+      _maxAcceleration = 0;
+    }
+#endif
+
+    /*
+      setScaling : changes the linear pulse width model set by setParameters,
+      for settings changed after startup.
+      Parameters:
+        center    the pulse width which centers the joint.
+        widthPerRadian    the pulse width to radian ratio which is signed to handle inverted servos.
+     */
+    void setScaling(int center, float widthPerRadian)
+    {
+      _center = center;
+      _widthPerRadian = widthPerRadian;
+    }
+
+    /*
+      setCalibration : replaces the linear pulse width model with pulse widths
+      measured at evenly spaced joint angles, which are interpolated linearly.
+      Angles beyond the ends of the table get the end pulse widths.
+      Parameters:
+        table     pulse widths in PROGMEM, in order of increasing joint angle.
+        points    number of entries, at least two.
+        firstAngle    joint angle of the first entry in radians.
+        spacing   radians between entries.
+     */
+    void setCalibration(const int16_t *table, byte points, float firstAngle, float spacing)
+    {
+      _table = table;
+      _firstAngle = firstAngle;
+      _indexScale = CALIBRATION_ONE / spacing;
+      _lastIndex = (int32_t)(points - 1) << CALIBRATION_FRACTION_BITS;
+    }
+
+    /*
+      setLimits : sets how fast the joint can turn, which the motion is slowed
+      to respect. Zero means unlimited, which is the default.
+      Parameters:
+        maxVelocity    fastest rotation in radians per second.
+        maxAcceleration    largest change in rotation speed in radians per second squared.
+     */
+    void setLimits(float maxVelocity, float maxAcceleration)
+    {
+      _maxVelocity = maxVelocity;
+      _maxAcceleration = maxAcceleration;
+    }
+
+    float getMaxVelocity()
+    {
+      return _maxVelocity;
+    }
+
+    float getMaxAcceleration()
+    {
+      return _maxAcceleration;
     }
 
     /*
@@ -35,21 +123,96 @@ class Joint
     void setPosition(float angle)
     {
       _angle = angle;
-      int pulseWidth = _center + fti(_widthPerRadian * angle);
+#ifdef PULSE_ENGINE
+      // The engine resolves fractions of a microsecond.
+      if (_table != NULL)
+      {
+        _engine->setPulse(_channel, lookupPulse(angle) * (1.0 / CALIBRATION_ONE));
+      }
+      else
+      {
+        _engine->setPulse(_channel, _center + _widthPerRadian * angle);
+      }
+#else
+      int pulseWidth;
+      if (_table != NULL)
+      {
+        pulseWidth = (lookupPulse(angle) + CALIBRATION_ONE / 2) >> CALIBRATION_FRACTION_BITS;
+      }
+      else
+      {
+        pulseWidth = _center + fti(_widthPerRadian * angle);
+      }
       
-      _servo->writeMicroseconds(pulseWidth);
+      // Skip writes which would not change the pulse.
+      if (pulseWidth != _pulseWidth)
+      {
+        _pulseWidth = pulseWidth;
+        _servo->writeMicroseconds(pulseWidth);
+      }
+#endif
+    }
+
+    /*
+      commit: makes the new position take effect. With the pulse engine every
+      joint set since the last commit moves from the same frame, otherwise
+      the servo was already written.
+    */
+    void commit()
+    {
+#ifdef PULSE_ENGINE
+      _engine->commit();
+#endif
     }
     
     float getPosition()
     {
       return _angle;
     }
+
+    /*
+      lookupPulse: Finds the pulse width for a joint angle in the calibration
+      table. The angle's position in the table is found with one multiply, so
+      the cost does not depend on the table size.
+      Returns the width in CALIBRATION_FRACTION_BITS fixed point.
+    */
+    int32_t lookupPulse(float angle)
+    {
+      int32_t index = (angle - _firstAngle) * _indexScale + 0.5;
+      index = constrain(index, 0, _lastIndex);
+      int i = index >> CALIBRATION_FRACTION_BITS;
+      if (index == _lastIndex)
+      {
+        // The last entry ends the segment before it.
+        i--;
+      }
+      int32_t fraction = index - ((int32_t)i << CALIBRATION_FRACTION_BITS);
+      int16_t low = pgm_read_word(_table + i);
+      int16_t high = pgm_read_word(_table + i + 1);
+      return ((int32_t)low << CALIBRATION_FRACTION_BITS) + (high - low) * fraction;
+    }
     
     private:
       float        _angle;
       int          _center;
       float        _widthPerRadian;
+
+      // Calibration table, or NULL to use the linear model above.
+      const int16_t* _table;
+      float        _firstAngle;
+      float        _indexScale;
+      int32_t      _lastIndex;
+
+      // Rotation limits, or zero for none.
+      float        _maxVelocity;
+      float        _maxAcceleration;
+#ifdef PULSE_ENGINE
+      PulseEngine* _engine;
+      byte         _channel;
+#else
+      int          _pulseWidth;
       Servo*       _servo;
+#endif
 };
 
 #endif  // Joint_H
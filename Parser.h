@@ -8,6 +8,13 @@
 //------------------------------------------------------------------------------
 // Copyright at end of file.
 
+#include "SerialRx.h"
+#include "BinaryProtocol.h"
+#include "Settings.h"
+#ifdef JOB_STORAGE
+#include "JobStorage.h"
+#endif
+
 #define LINE_BUFFER_SIZE 64
 
 // Define Grbl status codes.
@@ -26,6 +33,36 @@
 #define STATUS_ALARM_LOCK 12
 #define STATUS_OVERFLOW 13
 #define STATUS_VERSION 14
+#define STATUS_JOB_STORAGE_FAIL 15
+
+// Modal groups of G words. A line may hold one G word from each group. The
+// motion group also holds the non-modal commands, since the parser acts upon
+// one of them per line. Only the modes the firmware works in are accepted,
+// G20 inches, G91 incremental distances and G93 inverse time feed are not.
+#define MODAL_GROUP_MOTION 0    // G0, G1, G2, G3, G4, G28
+#define MODAL_GROUP_PLANE 1     // G17, G18, G19
+#define MODAL_GROUP_UNITS 2     // G21
+#define MODAL_GROUP_DISTANCE 3  // G90
+#define MODAL_GROUP_FEED 4      // G94
+#define MODAL_GROUP_UNSUPPORTED 0xFF
+
+// Significant digits kept when reading a number, so the mantissa fits in 32 bits.
+#define MAX_NUMBER_DIGITS 8
+
+// Number of coordinates passed to a GCodeProcessor (X, Y, Z, A, B, C).
+#define NUM_AXES 6
+
+// Largest distance in mm an arc segment's chord may stray from the true arc.
+#ifndef ARC_TOLERANCE
+#define ARC_TOLERANCE 0.05
+#endif
+
+// Arc segments are rotated incrementally, with the exact position computed
+// every ARC_CORRECTION segments to stop rounding errors building up.
+#define ARC_CORRECTION 12
+
+// Angular travel below which an arc ending where it starts is a full circle.
+#define ARC_ANGULAR_EPSILON 5E-7
 
 // define an abstract class to process g code commands.
 // The consumer's subclass provide implementation which
@@ -43,13 +80,242 @@ class GCodeProcessor
     virtual float getA() = 0;
     virtual float getB() = 0;
     virtual float getC() = 0;
-    virtual void setFeedrate(float f);
+    virtual void setFeedrate(float f) = 0;
     virtual void setHome(float x, float y, float z, float a, float b, float c) = 0;
     virtual void setPosition(float x, float y, float z, float a, float b, float c) = 0;
     virtual void movePosition(float x, float y, float z, float a, float b, float c) = 0;
-    virtual void enableVacuum(boolean enable);
+    virtual void enableVacuum(boolean enable) = 0;
+
+    // Called before the machine is stepped along a straight move from its
+    // position to the target, for machines whose joints do not move in
+    // straight lines to plan how to follow it.
+    virtual void beginLine(float x, float y, float z, float a, float b, float c)
+    {
+    }
+
+    // Lowers the speed in mm/s and acceleration in mm/s^2 of a straight move
+    // to what the machine's joints can follow. Called as the move is planned.
+    virtual void limitMove(const float *start, const float *target, float *speed, float *acceleration)
+    {
+    }
+
+    // Sends the pen towards a height, for machines which lift their pen with
+    // Z. Returns at once, penSeconds tells how long the pen takes to move.
+    virtual void movePen(float z)
+    {
+    }
+
+    // Seconds after the pen is sent from one height towards another until it
+    // passes a height on the way, or 0 for machines without a pen lift.
+    virtual float penSeconds(float from, float to, float height)
+    {
+      return 0;
+    }
+
+    // Height M10 lowers the pen to, or M11 raises it to.
+    virtual float penHeight(boolean down)
+    {
+      return 0;
+    }
+
+    // Pauses motion for the number of seconds.
+    virtual void dwell(float seconds)
+    {
+      delay(seconds * 1000);
+    }
+
+    // Returns true when another command can be accepted.
+    virtual boolean ready()
+    {
+      return true;
+    }
+
+    // Returns true once all accepted commands have completed.
+    virtual boolean idle()
+    {
+      return true;
+    }
+};
+
+// Breaks a circular arc into straight segments which stay within the chord
+// tolerance of the arc. This follows grbl's mc_arc, but hands out a segment
+// at a time so the caller can wait for room in the motion queue.
+class Arc
+{
+  public:
+    Arc()
+    {
+      _segments = 0;
+    }
+
+    /**
+     * Returns true while the arc has segments left to hand out.
+     */
+    boolean isActive()
+    {
+      return _segments > 0;
+    }
+
+    /**
+     * Drops the segments left to hand out.
+     */
+    void cancel()
+    {
+      _segments = 0;
+    }
+
+    /**
+     * Sets up an arc around a center given as offsets from the start. Axes
+     * outside the arc's plane move linearly alongside it.
+     * @param position the start of the arc.
+     * @param target the end of the arc.
+     * @param axis0 first axis of the arc's plane.
+     * @param axis1 second axis of the arc's plane.
+     * @param clockwise true for G2, false for G3.
+     * @param offset0 center offset from the start along axis0.
+     * @param offset1 center offset from the start along axis1.
+     * @return STATUS_OK, or STATUS_ARC_RADIUS_ERROR if the target is not on the arc.
+     */
+    int begin(const float *position, const float *target, byte axis0, byte axis1,
+              boolean clockwise, float offset0, float offset1)
+    {
+      float radius = hypot(offset0, offset1);
+      float center0 = position[axis0] + offset0;
+      float center1 = position[axis1] + offset1;
+      float rt0 = target[axis0] - center0;
+      float rt1 = target[axis1] - center1;
+      float error = fabs(hypot(rt0, rt1) - radius);
+      if (radius == 0 || (error > 0.005 && error > 0.001 * radius)) {
+        return STATUS_ARC_RADIUS_ERROR;
+      }
+
+      // Angle swept from start to target, in the direction of travel.
+      float r0 = -offset0;
+      float r1 = -offset1;
+      float travel = atan2(r0 * rt1 - r1 * rt0, r0 * rt0 + r1 * rt1);
+      if (clockwise) {
+        if (travel >= -ARC_ANGULAR_EPSILON) {
+          travel -= 2 * PI;
+        }
+      }
+      else if (travel <= ARC_ANGULAR_EPSILON) {
+        travel += 2 * PI;
+      }
+
+      // A chord of half length sqrt(tol * (2r - tol)) strays tol from the arc.
+      float tolerance = min(ARC_TOLERANCE, radius);
+      float halfChord = sqrt(tolerance * (2 * radius - tolerance));
+      _total = max(1, (int)floor(fabs(0.5 * travel * radius) / halfChord));
+      _segments = _total;
+      _theta = travel / _total;
+
+      // Small angle approximations of the rotation per segment.
+      _cosT = 2.0 - _theta * _theta;
+      _sinT = _theta * 0.16666667 * (_cosT + 4.0);
+      _cosT *= 0.5;
+
+      _axis0 = axis0;
+      _axis1 = axis1;
+      _center0 = center0;
+      _center1 = center1;
+      _r0 = r0;
+      _r1 = r1;
+      for (int i = 0; i < NUM_AXES; i++) {
+        _start[i] = position[i];
+        _target[i] = target[i];
+      }
+      return STATUS_OK;
+    }
+
+    /**
+     * Finds the center offsets of an arc given by its radius. Of the two arcs
+     * through the points, a positive radius takes the one under a half circle.
+     * @return STATUS_OK, or STATUS_ARC_RADIUS_ERROR if no arc fits.
+     */
+    static int offsetsFromRadius(const float *position, const float *target, byte axis0, byte axis1,
+                                 boolean clockwise, float radius, float *offset0, float *offset1)
+    {
+      float x = target[axis0] - position[axis0];
+      float y = target[axis1] - position[axis1];
+      float h_x2_div_d = 4 * radius * radius - x * x - y * y;
+      if ((x == 0 && y == 0) || h_x2_div_d < 0) {
+        return STATUS_ARC_RADIUS_ERROR;
+      }
+
+      h_x2_div_d = -sqrt(h_x2_div_d) / hypot(x, y);
+      if (!clockwise) {
+        h_x2_div_d = -h_x2_div_d;
+      }
+      if (radius < 0) {
+        h_x2_div_d = -h_x2_div_d;
+      }
+      *offset0 = 0.5 * (x - (y * h_x2_div_d));
+      *offset1 = 0.5 * (y + (x * h_x2_div_d));
+      return STATUS_OK;
+    }
+
+    /**
+     * Computes the end of the next segment. The last one ends on the target.
+     * @param point receives the coordinates.
+     */
+    void next(float *point)
+    {
+      _segments--;
+      int count = _total - _segments;
+      if (_segments == 0) {
+        for (int i = 0; i < NUM_AXES; i++) {
+          point[i] = _target[i];
+        }
+        return;
+      }
+
+      if (count % ARC_CORRECTION) {
+        float r = _r0 * _sinT + _r1 * _cosT;
+        _r0 = _r0 * _cosT - _r1 * _sinT;
+        _r1 = r;
+      }
+      else {
+        float cosTi = cos(count * _theta);
+        float sinTi = sin(count * _theta);
+        float r0 = _start[_axis0] - _center0;
+        float r1 = _start[_axis1] - _center1;
+        _r0 = r0 * cosTi - r1 * sinTi;
+        _r1 = r0 * sinTi + r1 * cosTi;
+      }
+
+      for (int i = 0; i < NUM_AXES; i++) {
+        point[i] = _start[i] + (_target[i] - _start[i]) * count / _total;
+      }
+      point[_axis0] = _center0 + _r0;
+      point[_axis1] = _center1 + _r1;
+    }
+
+  private:
+    float _start[NUM_AXES];
+    float _target[NUM_AXES];
+    byte _axis0;
+    byte _axis1;
+    float _center0;
+    float _center1;
+
+    // Vector from the center to the last point handed out.
+    float _r0;
+    float _r1;
+
+    // Angle and rotation per segment.
+    float _theta;
+    float _cosT;
+    float _sinT;
+
+    int _total;
+    int _segments;
 };
 
+// The parser drives a processor of the type given as its template parameter.
+// A final class there lets the compiler call it directly and inline its
+// getters, while Parser<> goes through the virtual GCodeProcessor interface
+// for builds mixing several kinds of processor.
+template <class Processor = GCodeProcessor>
 class Parser
 {
   public:
@@ -57,18 +323,41 @@ class Parser
       constructor used to bind the parser to a robot arm.
       Parameters:
         arm  reference to the robot arm.
+        rx   receive buffer of the serial port the commands arrive on, which
+             is also where they are answered.
      */
-    Parser(GCodeProcessor *processor)
+    Parser(Processor *processor, RxBuffer *rx = &serialRx)
     {
       _processor = processor;
+      _rx = rx;
+      _port = rx->port();
+      _lineReady = false;
+      _isComment = false;
+      _mPending = false;
+      _plane = 17;
+      _binary = false;
+      _fromJob = false;
     }
 
     /**
-     * Prepares the input buffer to receive a new message and tells the serial connected device it is ready for more.
+     * Prepares the input buffer to receive a new message. The device learns
+     * it may send more from the "ok" or error, as grbl senders expect.
      */
     void reset() {
       iter = 0;              // clear input buffer
-      Serial.print(F("> ")); // signal ready to receive input
+      _lineReady = false;
+    }
+
+    /**
+     * Abandons the line in progress along with the rest of any arc, and
+     * returns to G-code text with the default plane, for a soft reset.
+     */
+    void abort() {
+      _arc.cancel();
+      _mPending = false;
+      _isComment = false;
+      _plane = 17;
+      endFrames();
     }
 
     /**
@@ -76,62 +365,140 @@ class Parser
      */
     void listen()
     {
-      boolean iscomment = false;
+#ifndef __AVR__
+      // Without the timer interrupt the receive ring is filled from here.
+      _rx->fill();
+#endif
+
+      if (_binary) {
+        listenFrames();
+        return;
+      }
+#ifdef JOB_STORAGE
+      if (ownsJobs() && jobs.isPlaying()) {
+        listenJob();
+        return;
+      }
+#endif
+      listenTo(_rx);
+    }
+
+    /**
+     * Reads lines from the input and deals with them. The input is anything
+     * with available() and read() like the receive buffer.
+     */
+    template <class Input>
+    void listenTo(Input *input)
+    {
+      // A completed line is held until the processor can accept it. Later
+      // input stays where it is meanwhile.
+      if (_lineReady) {
+        if (_arc.isActive() || _mPending) {
+          // Queue more of an arc, or the line's M word, as room frees up.
+          if (!finishLine()) {
+            return;
+          }
+          acknowledge(STATUS_OK);
+          reset();
+        }
+        else {
+          // The line was tokenized when it completed.
+          if (!canProcess() || !executeLine()) {
+            return;
+          }
+        }
+      }
 
       // listen for serial commands
-      while(Serial.available() > 0) {
+      while(input->available() > 0) {
         // Read input when it is available.
-        char c = Serial.read();
+        char c = input->read();
 
         // if end of line reached
         if ((c == '\n') || (c == '\r')) {
           if (iter > 0) {// Line is complete. Then execute!
             buffer[iter] = 0; // Terminate string
-            reportMessage(processCommand());
-          }
-          else {
-            // Empty or comment line. Skip block.
-            reportMessage(STATUS_OK); // Send status message for syncing purposes.
-          }
-
-          reset();
-        }
-        else {
-          if (iscomment) {
-            // Throw away all comment characters
-            if (c == ')') {
-              // End of comment. Resume line.
-              iscomment = false;
-            }
-          }
-          else {
-            if (c <= ' ') {
-              // Throw away whitepace and control characters
-              // except control x which gets the version string
-              if (c == 24)
-                reportMessage(STATUS_VERSION);
-            }
-            else if (c == '/') { 
-              // Block delete not supported. Ignore character.
+            _isComment = false;
+#ifdef JOB_STORAGE
+            if (ownsJobs() && jobs.isUploading()) {
+              reportMessage(storeLine());
+              reset();
+              continue;
             }
-            else if (c == '(') {
-              // Enable comments flag and ignore all characters until ')' or EOL.
-              iscomment = true;
+#endif
+            if (buffer[0] == '$') {
+              // System commands act at once rather than being queued.
+              acknowledge(systemCommand());
+              reset();
+              if (_binary || switchedToJob()) {
+                // The rest of the input is frames, or waits for the job.
+                return;
+              }
+              continue;
             }
-            else if (iter >= LINE_BUFFER_SIZE-1) {
-              // Report line buffer overflow and reset
-              reportMessage(STATUS_OVERFLOW);
+            int status = tokenize();
+            if (status != STATUS_OK) {
+              acknowledge(status);
               reset();
             }
-            else if (c >= 'a' && c <= 'z') { // Upcase lowercase
-              buffer[iter++] = c-'a'+'A';
+            else if (!canProcess()) {
+              _lineReady = true;
+              return;
             }
-            else {
-              buffer[iter++] = c;
+            else if (!executeLine()) {
+              return;
             }
           }
+          else {
+            // Empty or comment line. Skip block.
+            acknowledge(STATUS_OK); // Send status message for syncing purposes.
+            reset();
+          }
+        }
+        else if (addChar(c) != STATUS_OK) {
+          // Report line buffer overflow and reset
+          acknowledge(STATUS_OVERFLOW);
+          reset();
+        }
+      }
+    }
+
+    /**
+     * Returns true while a line is held until the processor has room for it,
+     * such as the rest of a long arc.
+     */
+    boolean isBusy() {
+      return _lineReady;
+    }
+
+    /**
+     * Parses and executes a whole line without reporting on the serial port.
+     * An arc which does not fit in the processor's queue, and any M word
+     * after it, is left for listen to finish.
+     * @input line the text of the line, without its end.
+     * @return the status listen would have reported.
+     */
+    int parseLine(const char *line) {
+      iter = 0;
+      _isComment = false;
+      for (; *line != 0; line++) {
+        if (addChar(*line) != STATUS_OK) {
+          iter = 0;
+          return STATUS_OVERFLOW;
         }
       }
+      buffer[iter] = 0;
+
+      int status = STATUS_OK;
+      if (iter > 0) {
+        status = tokenize();
+        if (status == STATUS_OK) {
+          status = processCommand();
+          _lineReady = _arc.isActive() || _mPending;
+        }
+      }
+      iter = 0;
+      return status;
     }
     
     /*
@@ -141,52 +508,338 @@ class Parser
     {
       if (status_code == 0)
       { // STATUS_OK
-        Serial.print(F("ok\r\n"));
+        _port->print(F("ok\r\n"));
       }
       else if (status_code == STATUS_VERSION)
       {
-        Serial.print(F("Grbl v0.8c ['$' for help]\r\n"));
+        _port->print(F("Grbl v0.8c ['$' for help]\r\n"));
+        // Receive buffer size for character counting senders.
+        _port->print(F("[RX:"));
+        _port->print(_rx->capacity());
+        _port->print(F("]\r\n"));
       }
       else
       {
-        Serial.print(F("error: "));
+        _port->print(F("error: "));
         switch (status_code)
         {          
           case STATUS_BAD_NUMBER_FORMAT:
-            Serial.print(F("Bad number format")); break;
+            _port->print(F("Bad number format")); break;
           case STATUS_EXPECTED_COMMAND_LETTER:
-            Serial.print(F("Expected command letter")); break;
+            _port->print(F("Expected command letter")); break;
           case STATUS_UNSUPPORTED_STATEMENT:
-            Serial.print(F("Unsupported statement")); break;
+            _port->print(F("Unsupported statement")); break;
           case STATUS_ARC_RADIUS_ERROR:
-            Serial.print(F("Invalid radius")); break;
+            _port->print(F("Invalid radius")); break;
           case STATUS_MODAL_GROUP_VIOLATION:
-            Serial.print(F("Modal group violation")); break;
+            _port->print(F("Modal group violation")); break;
           case STATUS_INVALID_STATEMENT:
-            Serial.print(F("Invalid statement")); break;
+            _port->print(F("Invalid statement")); break;
           case STATUS_SETTING_DISABLED:
-            Serial.print(F("Setting disabled")); break;
+            _port->print(F("Setting disabled")); break;
           case STATUS_SETTING_VALUE_NEG:
-            Serial.print(F("Value < 0.0")); break;
+            _port->print(F("Value < 0.0")); break;
           case STATUS_SETTING_STEP_PULSE_MIN:
-            Serial.print(F("Value < 3 usec")); break;
+            _port->print(F("Value < 3 usec")); break;
           case STATUS_SETTING_READ_FAIL:
-            Serial.print(F("EEPROM read fail. Using defaults")); break;
+            _port->print(F("EEPROM read fail. Using defaults")); break;
           case STATUS_IDLE_ERROR:
-            Serial.print(F("Busy or queued")); break;
+            _port->print(F("Busy or queued")); break;
           case STATUS_ALARM_LOCK:
-            Serial.print(F("Alarm lock")); break;
+            _port->print(F("Alarm lock")); break;
           case STATUS_OVERFLOW:
-            Serial.print(F("Line overflow")); break;
+            _port->print(F("Line overflow")); break;
+          case STATUS_JOB_STORAGE_FAIL:
+            _port->print(F("Job storage failed")); break;
         }
       }
-      Serial.print(F("\r\n"));
+      _port->print(F("\r\n"));
     }
 
   private:
-    GCodeProcessor * _processor;
+    Processor * _processor;
+    RxBuffer * _rx;
+    HardwareSerial * _port;
     char buffer[LINE_BUFFER_SIZE];
     int iter;  
+    boolean _lineReady;
+    boolean _isComment;
+
+    // Words of the current line, indexed by letter. A bit is set in _words
+    // for each letter present.
+    float _values[26];
+    uint32_t _words;
+
+    // Active plane for arcs, G17, G18 or G19, and the plane word on the
+    // current line if any.
+    int _plane;
+    int _linePlane;
+
+    // Arc whose segments are still being queued.
+    Arc _arc;
+
+    // Set while the line's M word waits for room in the processor's queue.
+    boolean _mPending;
+
+    // Set while the input is binary frames, and while a decoded frame is
+    // held until the processor can accept it.
+    boolean _binary;
+    boolean _frameReady;
+    FrameDecoder _frames;
+
+    // When the input last moved on while frames were expected, in ms.
+    unsigned long _frameTime;
+
+    // Set while the input is a stored job.
+    boolean _fromJob;
+
+    /**
+     * Reports the status of a line. Lines of a stored job only report
+     * errors, given with the job's line number.
+     */
+    void acknowledge(int status) {
+#ifdef JOB_STORAGE
+      if (_fromJob) {
+        if (status != STATUS_OK) {
+          _port->print(F("[JOB LINE:"));
+          _port->print(jobs.line());
+          _port->print(F("] "));
+          reportMessage(status);
+        }
+        return;
+      }
+#endif
+      reportMessage(status);
+    }
+
+    /**
+     * Returns true if a line read from the serial port started a job, whose
+     * lines come before the rest of the serial input.
+     */
+    boolean switchedToJob() {
+#ifdef JOB_STORAGE
+      return !_fromJob && ownsJobs() && jobs.isPlaying();
+#else
+      return false;
+#endif
+    }
+
+#ifdef JOB_STORAGE
+    /**
+     * Returns true if this parser reads the first serial port. Only it may
+     * store and run jobs, so with several arms the card has one owner.
+     */
+    boolean ownsJobs() {
+      return _rx == &serialRx;
+    }
+
+    /**
+     * Reads the lines of the stored job being played, with the card read
+     * ahead first so it is not waited on when the parser needs more.
+     */
+    void listenJob() {
+      jobs.prefetch();
+      _fromJob = true;
+      listenTo(&jobs);
+      _fromJob = false;
+      if (jobs.isFinished() && !_lineReady) {
+        jobs.stop();
+        _port->print(F("[JOB DONE]\r\n"));
+      }
+    }
+
+    /**
+     * Stores a line of the job being uploaded, or finishes the upload on a
+     * line holding just "%".
+     * @return the status to report.
+     */
+    int storeLine() {
+      if (strcmp(buffer, "%") == 0) {
+        jobs.stop();
+        return STATUS_OK;
+      }
+      if (!jobs.write(buffer)) {
+        jobs.stop();
+        return STATUS_JOB_STORAGE_FAIL;
+      }
+      return STATUS_OK;
+    }
+#endif
+
+    /**
+     * Executes a line starting with '$'. "$B" switches the input to the
+     * binary protocol, "$$" lists the settings and "$n=value" changes one.
+     * With JOB_STORAGE "$U=name" uploads a job and "$R=name" runs one.
+     * @return the status to report.
+     */
+    int systemCommand() {
+#ifdef JOB_STORAGE
+      if (!ownsJobs()) {
+        if (buffer[1] == 'R' || buffer[1] == 'U') {
+          return STATUS_UNSUPPORTED_STATEMENT;
+        }
+      }
+      else if (strncmp(buffer, "$R=", 3) == 0) {
+        // A job may end by running another.
+        return jobs.play(buffer + 3) ? STATUS_OK : STATUS_JOB_STORAGE_FAIL;
+      }
+      if (_fromJob) {
+        // The rest would take over the serial port.
+        if (buffer[1] == 'B' || buffer[1] == 'U') {
+          return STATUS_UNSUPPORTED_STATEMENT;
+        }
+      }
+      else if (strncmp(buffer, "$U=", 3) == 0) {
+        return jobs.upload(buffer + 3) ? STATUS_OK : STATUS_JOB_STORAGE_FAIL;
+      }
+#endif
+      if (strcmp(buffer, "$B") == 0) {
+        _binary = true;
+        _rx->setBinary(true);
+        _frameReady = false;
+        _frames.begin();
+        _frameTime = millis();
+        return STATUS_OK;
+      }
+      if (strcmp(buffer, "$$") == 0) {
+        settings.report(_port);
+        return STATUS_OK;
+      }
+
+      char *ptr = buffer + 1;
+      float n, value;
+      if (!parseNumber(&ptr, &n) || *ptr++ != '=' || !parseNumber(&ptr, &value) || *ptr != 0) {
+        return STATUS_UNSUPPORTED_STATEMENT;
+      }
+      if (n < 0 || n >= SETTINGS_COUNT || n != (int)n) {
+        return STATUS_INVALID_STATEMENT;
+      }
+      // Settings such as the offsets would upset moves already queued, on
+      // any arm sharing them.
+      if (!settings.canChange()) {
+        return STATUS_IDLE_ERROR;
+      }
+      if (!settings.set((byte)n, value)) {
+        return STATUS_SETTING_VALUE_NEG;
+      }
+      return STATUS_OK;
+    }
+
+    /**
+     * Decodes binary frames from the serial input and executes them, as
+     * listen does for lines.
+     */
+    void listenFrames() {
+      if (_frameReady) {
+        // The sender waits for this frame's answer.
+        _frameTime = millis();
+        if (!canExecuteFrame()) {
+          return;
+        }
+        executeFrame();
+      }
+
+      if (_rx->available() > 0) {
+        _frameTime = millis();
+      }
+      else if (!_frames.held() && millis() - _frameTime > FRAME_TIMEOUT) {
+        // The sender has gone, as if it had sent FRAME_END.
+        _port->print(F("[BINARY TIMEOUT]\r\n"));
+        endFrames();
+        return;
+      }
+
+      while (_binary && (_frames.held() || _rx->available() > 0)) {
+        // Bytes kept after a frame dropped part way are scanned first.
+        byte result = _frames.held() ? _frames.scan() : _frames.add(_rx->read());
+        if (result == FRAME_RESEND) {
+          _port->print(F("[RESEND:"));
+          _port->print(_frames.expected());
+          _port->print(F("]\r\n"));
+        }
+        else if (result == FRAME_READY) {
+          if (!canExecuteFrame()) {
+            _frameReady = true;
+            return;
+          }
+          executeFrame();
+        }
+      }
+    }
+
+    /**
+     * Checks if the processor can accept the decoded frame now, with the
+     * same rules as canProcess.
+     */
+    boolean canExecuteFrame() {
+      if (!_processor->ready()) {
+        return false;
+      }
+      return _frames.type() != FRAME_HOME || _processor->idle();
+    }
+
+    /**
+     * Passes the decoded frame to the processor and acknowledges it.
+     */
+    void executeFrame() {
+      const float scale = 1.0 / FRAME_UNITS_PER_MM;
+      float z = _processor->getZ();
+      float a = _processor->getA();
+      float b = _processor->getB();
+      float c = _processor->getC();
+      switch (_frames.type()) {
+      case FRAME_LINEAR:
+        _processor->movePosition(_frames.word(0) * scale, _frames.word(2) * scale, z, a, b, c);
+        break;
+      case FRAME_RAPID:
+        _processor->setPosition(_frames.word(0) * scale, _frames.word(2) * scale, z, a, b, c);
+        break;
+      case FRAME_STEP:
+        // Steps are from the position rounded to the frame units, so
+        // rounding does not build up over many of them.
+        _processor->movePosition(
+          (lround(_processor->getX() * FRAME_UNITS_PER_MM) + (int8_t)_frames.payload(0)) * scale,
+          (lround(_processor->getY() * FRAME_UNITS_PER_MM) + (int8_t)_frames.payload(1)) * scale,
+          z, a, b, c);
+        break;
+      case FRAME_LINEAR_Z:
+        _processor->movePosition(_frames.word(0) * scale, _frames.word(2) * scale,
+                                 _frames.word(4) * scale, a, b, c);
+        break;
+      case FRAME_RAPID_Z:
+        _processor->setPosition(_frames.word(0) * scale, _frames.word(2) * scale,
+                                _frames.word(4) * scale, a, b, c);
+        break;
+      case FRAME_FEED:
+        _processor->setFeedrate((uint16_t)_frames.word(0));
+        break;
+      case FRAME_DWELL:
+        _processor->dwell((uint16_t)_frames.word(0) / 1000.0);
+        break;
+      case FRAME_HOME:
+        _processor->park();
+        break;
+      case FRAME_VACUUM:
+        _processor->enableVacuum(_frames.payload(0) != 0);
+        break;
+      case FRAME_END:
+        endFrames();
+        break;
+      }
+      _frames.next();
+      _frameReady = false;
+      reportMessage(STATUS_OK);
+    }
+
+    /**
+     * Returns from binary frames to G-code text.
+     */
+    void endFrames() {
+      _binary = false;
+      _frameReady = false;
+      _rx->setBinary(false);
+      reset();
+    }
 
     /** Allows human to enter degrees
      */
@@ -209,20 +862,331 @@ class Parser
      * @input val the return value if code is not found.
      **/
     float getArgument(char code, float val) {
+      if (hasArgument(code)) {
+        return _values[code - 'A'];
+      }
+      return val;
+    }
+
+    /**
+     * Checks if a word is present on the line.
+     * @input code the character to look for.
+     **/
+    boolean hasArgument(char code) {
+      return (_words & (1UL << (code - 'A'))) != 0;
+    }
+
+    /**
+     * Splits the line into its words in a single pass, so each argument can be
+     * looked up without rescanning the buffer.
+     * @return STATUS_OK, or the error found in the line.
+     */
+    int tokenize() {
       char* ptr = buffer;
-      while (ptr && *ptr && ptr < buffer + iter) {
-        if (*ptr == code) {
-          return atof(ptr + 1);
+      byte groups = 0;
+      _words = 0;
+      _linePlane = 0;
+
+      while (*ptr) {
+        char letter = *ptr++;
+        if (letter < 'A' || letter > 'Z') {
+          return STATUS_EXPECTED_COMMAND_LETTER;
         }
+
+        float value;
+        if (!parseNumber(&ptr, &value)) {
+          return STATUS_BAD_NUMBER_FORMAT;
+        }
+
+        // G words from different modal groups may share a line, but only
+        // the motion group's is acted upon.
+        if (letter == 'G') {
+          byte code = modalGroup(value);
+          if (code == MODAL_GROUP_UNSUPPORTED) {
+            return STATUS_UNSUPPORTED_STATEMENT;
+          }
+          byte group = 1 << code;
+          if (groups & group) {
+            return STATUS_MODAL_GROUP_VIOLATION;
+          }
+          groups |= group;
+          if (group == (1 << MODAL_GROUP_PLANE)) {
+            _linePlane = (int)value;
+          }
+          if (group != (1 << MODAL_GROUP_MOTION)) {
+            continue;
+          }
+        }
+
+        uint32_t word = 1UL << (letter - 'A');
+        if (_words & word) {
+          return STATUS_MODAL_GROUP_VIOLATION;
+        }
+        _words |= word;
+        _values[letter - 'A'] = value;
+      }
+      return STATUS_OK;
+    }
+
+    /**
+     * Reads a decimal number with an optional sign and decimal point.
+     * @input text pointer to the first character, advanced past the number.
+     * @input value receives the number.
+     * @return false if there are no digits.
+     */
+    boolean parseNumber(char **text, float *value) {
+      char* ptr = *text;
+      boolean negative = false;
+      if (*ptr == '-' || *ptr == '+') {
+        negative = (*ptr == '-');
         ptr++;
       }
-      return val;
+
+      uint32_t mantissa = 0;
+      int exponent = 0;
+      byte digits = 0;
+      boolean point = false;
+      for (;; ptr++) {
+        char c = *ptr;
+        if (c >= '0' && c <= '9') {
+          if (digits < MAX_NUMBER_DIGITS) {
+            mantissa = mantissa * 10 + (c - '0');
+            if (point) {
+              exponent--;
+            }
+          }
+          else if (!point) {
+            exponent++;
+          }
+          digits++;
+        }
+        else if (c == '.' && !point) {
+          point = true;
+        }
+        else {
+          break;
+        }
+      }
+
+      if (digits == 0) {
+        return false;
+      }
+
+      // Powers of ten up to 10^8 are exact in a float, so a single divide
+      // rounds the same as atof.
+      float scale = 1;
+      for (; exponent < 0; exponent++) {
+        scale *= 10;
+      }
+      float result = mantissa / scale;
+      for (; exponent > 0; exponent--) {
+        result *= 10;
+      }
+
+      *value = negative ? -result : result;
+      *text = ptr;
+      return true;
+    }
+
+    /**
+     * Returns the modal group of a G word, or MODAL_GROUP_UNSUPPORTED for
+     * words the firmware does not implement.
+     */
+    byte modalGroup(float value) {
+      int code = (int)value;
+      if (code != value) {
+        return MODAL_GROUP_UNSUPPORTED;
+      }
+      switch (code) {
+      case 0: case 1: case 2: case 3: case 4: case 28:
+        return MODAL_GROUP_MOTION;
+      case 17: case 18: case 19:
+        return MODAL_GROUP_PLANE;
+      case 21:
+        return MODAL_GROUP_UNITS;
+      case 90:
+        return MODAL_GROUP_DISTANCE;
+      case 94:
+        return MODAL_GROUP_FEED;
+      default:
+        return MODAL_GROUP_UNSUPPORTED;
+      }
+    }
+
+    /**
+     * Checks if the processor can accept the line in the buffer now. Any
+     * command needs room in its queue, while homing, offsets and position
+     * reports must also wait for queued motion to finish.
+     */
+    boolean canProcess() {
+      if (!_processor->ready()) {
+        return false;
+      }
+
+      int g = getArgument('G', -1);
+      int m = getArgument('M', -1);
+      if (g == 28 || m == 114 || m == 206) {
+        return _processor->idle();
+      }
+      return true;
+    }
+
+    /**
+     * Adds a character to the line being assembled, dropping whitespace and
+     * comments and folding letters to upper case.
+     * @return STATUS_OK or STATUS_OVERFLOW if the line is too long.
+     */
+    int addChar(char c) {
+      if (_isComment) {
+        // Throw away all comment characters
+        if (c == ')') {
+          // End of comment. Resume line.
+          _isComment = false;
+        }
+      }
+      else {
+        if (c <= ' ') {
+          // Throw away whitepace and control characters. Control X never
+          // gets here, the receive buffer takes it as a soft reset.
+        }
+        else if (c == '/') { 
+          // Block delete not supported. Ignore character.
+        }
+        else if (c == '(') {
+          // Enable comments flag and ignore all characters until ')' or EOL.
+          _isComment = true;
+        }
+        else if (iter >= LINE_BUFFER_SIZE-1) {
+          return STATUS_OVERFLOW;
+        }
+        else if (c >= 'a' && c <= 'z') { // Upcase lowercase
+          buffer[iter++] = c-'a'+'A';
+        }
+        else {
+          buffer[iter++] = c;
+        }
+      }
+      return STATUS_OK;
+    }
+
+    /**
+     * Executes the tokenized line and reports its status. An arc may need
+     * more room in the queue than is free, in which case the line is held
+     * and the rest of the arc is queued by later calls to listen.
+     * @return true if the line is complete.
+     */
+    boolean executeLine() {
+      int status = processCommand();
+      if (status == STATUS_OK && (_arc.isActive() || _mPending)) {
+        _lineReady = true;
+        return false;
+      }
+      acknowledge(status);
+      reset();
+      return true;
+    }
+
+    /**
+     * Begins a G2 or G3 arc from the current position, given either by the
+     * center offsets I, J and K or by the radius R.
+     * @return STATUS_OK or the error in the arc's words.
+     */
+    int startArc(boolean clockwise) {
+      float position[NUM_AXES] = { _processor->getX(), _processor->getY(), _processor->getZ(),
+                                   _processor->getA(), _processor->getB(), _processor->getC() };
+      float target[NUM_AXES] = { getArgument('X', position[0]), getArgument('Y', position[1]),
+                                 getArgument('Z', position[2]),
+                                 deg2Rad( getArgument('A', rad2Deg(position[3])) ),
+                                 deg2Rad( getArgument('B', rad2Deg(position[4])) ),
+                                 deg2Rad( getArgument('C', rad2Deg(position[5])) ) };
+
+      // Axes of the plane, G17 is XY, G18 is ZX and G19 is YZ.
+      byte axis0 = 0;
+      byte axis1 = 1;
+      if (_plane == 18) {
+        axis0 = 2;
+        axis1 = 0;
+      }
+      else if (_plane == 19) {
+        axis0 = 1;
+        axis1 = 2;
+      }
+
+      // I, J and K hold the center offset along X, Y and Z respectively.
+      char letter0 = 'I' + axis0;
+      char letter1 = 'I' + axis1;
+      float offset0, offset1;
+      if (hasArgument('R')) {
+        int status = Arc::offsetsFromRadius(position, target, axis0, axis1, clockwise,
+                                            getArgument('R', 0), &offset0, &offset1);
+        if (status != STATUS_OK) {
+          return status;
+        }
+      }
+      else if (hasArgument(letter0) || hasArgument(letter1)) {
+        offset0 = getArgument(letter0, 0);
+        offset1 = getArgument(letter1, 0);
+      }
+      else {
+        return STATUS_INVALID_STATEMENT;
+      }
+
+      int status = _arc.begin(position, target, axis0, axis1, clockwise, offset0, offset1);
+      if (status == STATUS_OK) {
+        queueArc();
+      }
+      return status;
+    }
+
+    /**
+     * Passes arc segments to the processor while it has room for them.
+     * @return true once the whole arc is queued.
+     */
+    boolean queueArc() {
+      while (_arc.isActive() && _processor->ready()) {
+        float p[NUM_AXES];
+        _arc.next(p);
+        _processor->movePosition(p[0], p[1], p[2], p[3], p[4], p[5]);
+      }
+      return !_arc.isActive();
+    }
+
+    /**
+     * Queues what is left of a held line as room frees up: the rest of an
+     * arc, and then the line's M word, which may queue a block of its own.
+     * @return true once the line is complete.
+     */
+    boolean finishLine() {
+      if (!queueArc()) {
+        return false;
+      }
+      if (_mPending) {
+        if (!_processor->ready()) {
+          return false;
+        }
+        _mPending = false;
+        miscCommand();
+      }
+      return true;
     }
 
     /**
      * Read the input buffer and find any recognized commands.  One G or M command per line.
      */
     int processCommand() {
+      int status = STATUS_OK;
+      if (_linePlane != 0) {
+        _plane = _linePlane;
+      }
+
+      // Feed rate command used to change end effector speed. It applies to
+      // any move on the same line.
+      float feedrate = getArgument('F', -1);
+      if (feedrate != -1)
+      {
+        _processor->setFeedrate(feedrate);
+      }
+
       int cmd = getArgument('G', -1);
       switch(cmd) {
       case  0: // fast linear (use sparingly because of inertia).
@@ -237,9 +1201,14 @@ class Parser
                            deg2Rad( getArgument('B', rad2Deg(_processor->getB())) ),
                            deg2Rad( getArgument('C', rad2Deg(_processor->getC())) ));
         break;
+      case  2: // clockwise arc
+      case  3: // counter clockwise arc
+        status = startArc(cmd == 2);
+        break;
+
       // pause
       case  4:
-        delay( getArgument('P', 0) * 1000);
+        _processor->dwell( getArgument('P', 0) );
         break;
 
       // home g code parks the arm
@@ -247,45 +1216,55 @@ class Parser
         _processor->park();
         break;
 
-      // don't do anything on an unrecognized code.
+      // a line without a motion word, tokenize rejects unknown G words.
       default:
         break;
       }
-      
-      // Feed rate command used to change end effector interpolation
-      cmd = getArgument('F', -1);
-      if (cmd != -1)
-      {
-        _processor->setFeedrate(cmd);
+
+      // The M word may need a block of its own, which follows the whole of
+      // the G word's motion.
+      if (hasArgument('M')) {
+        if (!_arc.isActive() && _processor->ready()) {
+          miscCommand();
+        }
+        else {
+          _mPending = true;
+        }
       }
+      return status;
+    }
 
+    /**
+     * Executes the line's M word.
+     */
+    void miscCommand() {
       // Miscellaneous commands used for end effector control.
-      cmd = getArgument('M', -1);
+      int cmd = getArgument('M', -1);
       switch (cmd)
       {
-        // Motor command is used to enable vacuum system
+        // Motor command is used to enable vacuum system, or lower the pen
       case 10:
         _processor->enableVacuum(true);
         break;
 
-      // Motor command is used to disable vacuum system
+      // Motor command is used to disable vacuum system, or raise the pen
       case 11:
         _processor->enableVacuum(false);
         break;
         
       case 114:
-        Serial.print(F("X="));
-        Serial.print(_processor->getX());
-        Serial.print(F(", Y="));
-        Serial.print(_processor->getY());
-        Serial.print(F(", Z="));
-        Serial.print(_processor->getZ());
-        Serial.print(F(", A="));
-        Serial.print(rad2Deg(_processor->getA()));
-        Serial.print(F(", B="));
-        Serial.print(rad2Deg(_processor->getB()));
-        Serial.print(F(", C="));
-        Serial.println(rad2Deg(_processor->getC()));
+        _port->print(F("X="));
+        _port->print(_processor->getX());
+        _port->print(F(", Y="));
+        _port->print(_processor->getY());
+        _port->print(F(", Z="));
+        _port->print(_processor->getZ());
+        _port->print(F(", A="));
+        _port->print(rad2Deg(_processor->getA()));
+        _port->print(F(", B="));
+        _port->print(rad2Deg(_processor->getB()));
+        _port->print(F(", C="));
+        _port->println(rad2Deg(_processor->getC()));
         break;
       case 206:
         _processor->setHome( getArgument('X', _processor->getX()), getArgument('Y', _processor->getY()), getArgument('Z', _processor->getZ()),
@@ -298,8 +1277,6 @@ class Parser
       default:
         break;
       }
-      
-      return STATUS_OK;
     }
 };
 
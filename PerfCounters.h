@@ -0,0 +1,85 @@
+//------------------------------------------------------------------------------
+// PerfCounters - counts kept when PERF_COUNTERS is defined, which show
+// whether a slow job is limited by the serial link, the CPU or the servos.
+// They are reported with each status report and then start over.
+//------------------------------------------------------------------------------
+// Copyright at end of file.
+
+#ifndef PerfCounters_H
+#define PerfCounters_H
+
+class PerfCounters
+{
+public:
+  PerfCounters()
+  {
+    _lastLoop = 0;
+    reset();
+  }
+
+  /**
+   * Starts the counts over.
+   */
+  void reset()
+  {
+    solves = 0;
+    rejections = 0;
+    starvedTicks = 0;
+    worstLoopMicros = 0;
+    since = micros();
+  }
+
+  /**
+   * Called at the top of loop() to track the longest time between passes,
+   * which is how late serial input or a tick may be handled.
+   */
+  void loopStarted()
+  {
+    unsigned long now = micros();
+    if (_lastLoop != 0)
+    {
+      worstLoopMicros = max(worstLoopMicros, now - _lastLoop);
+    }
+    _lastLoop = now;
+  }
+
+  // Inverse kinematics solutions computed.
+  unsigned long solves;
+
+  // Positions refused by the arm as out of reach.
+  unsigned long rejections;
+
+  // Executor ticks spent waiting for the next move of a job.
+  unsigned long starvedTicks;
+
+  unsigned long worstLoopMicros;
+
+  // When the counts started, in micros.
+  unsigned long since;
+
+private:
+  unsigned long _lastLoop;
+};
+
+static PerfCounters perf;
+
+#endif  // PerfCounters_H
+
+/*
+┌──────────────────────────────────────────────────────────────────────────┐
+│                                                   TERMS OF USE: MIT License                                                   │
+├──────────────────────────────────────────────────────────────────────────┤
+│Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation     │
+│files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,     │
+│modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software │
+│is furnished to do so, subject to the following conditions:                                                                    │
+│                                                                                                                               │
+│The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. │
+│                                                                                                                               │
+│THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE           │
+│WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR          │
+│COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,    │
+│ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                          │
+└──────────────────────────────────────────────────────────────────────────┘
+*/
+
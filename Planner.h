@@ -0,0 +1,514 @@
+//------------------------------------------------------------------------------
+// Planner class - queues parsed motion blocks between the parser and the arm.
+// The parser fills the queue and acknowledges each line as soon as its block
+// is stored, so the next line arrives while the current block executes.
+//
+// Linear blocks also get a velocity plan, following grbl: each block has a
+// nominal speed from its F word, and its entry speed is capped by the angle it
+// turns from the previous block (junction deviation) and by what can be
+// reached under constant acceleration across the queued blocks.
+//
+// Z is the pen's height rather than part of the path. A block which changes
+// it starts from rest, as the executor moves the pen before the block's X
+// and Y, and M10 and M11 queue a move of the pen alone. G28 is queued too,
+// so the executor lifts the pen clear of the paper before the arm parks.
+//------------------------------------------------------------------------------
+// Copyright at end of file.
+
+#ifndef Planner_H
+#define Planner_H
+
+#include "Parser.h"
+
+// Number of blocks which can be queued ahead of the arm. Kept small because
+// each block costs RAM on the ATmega.
+#ifndef BLOCK_BUFFER_SIZE
+#define BLOCK_BUFFER_SIZE 8
+#endif
+
+// Uncomment to ramp speed along an S-curve rather than a trapezoid. The ramp
+// keeps the same peak acceleration but takes 1.5 times as long, in exchange
+// acceleration rises and falls smoothly instead of switching on and off.
+// #define S_CURVE_ACCELERATION
+
+// Kinds of queued blocks. Only moves carry a target position.
+#define BLOCK_RAPID 0
+#define BLOCK_LINEAR 1
+#define BLOCK_DWELL 2
+#define BLOCK_PARK 3
+
+// A parsed command waiting to be executed. Targets are absolute with angles
+// already in radians. Dwell blocks keep their argument in target[0], park
+// blocks only the raised pen's height in target[2].
+// Speeds are in mm/s and acceleration in mm/s^2.
+struct MotionBlock
+{
+  byte  type;
+  float target[NUM_AXES];
+  float feedrate;
+
+  // Prepared by the planner for linear blocks.
+  float millimeters;
+  float acceleration;
+  float nominalSpeed;
+  float maxEntrySpeed;
+  float entrySpeed;
+};
+
+class Planner final : public GCodeProcessor
+{
+public:
+  /**
+   * Constructor used to bind the planner to the machine executing its blocks.
+   * @param machine - the robot which performs the motion.
+   * @param feedrate - default tool speed in mm/min until an F word is seen.
+   * @param acceleration - tool acceleration limit in mm/s^2.
+   * @param junctionDeviation - distance in mm the path may be imagined to
+   *   round a corner by, which sets how fast corners may be taken.
+   */
+  Planner(GCodeProcessor *machine, float feedrate, float acceleration, float junctionDeviation)
+  {
+    _machine = machine;
+    _head = 0;
+    _tail = 0;
+    _busy = false;
+    _parking = false;
+    _feedrate = feedrate;
+    _acceleration = acceleration;
+    _junctionDeviation = junctionDeviation;
+    _previousSpeed = 0;
+    syncPosition();
+  }
+
+  /**
+   * Park - queues the machine's park after a lift of the pen. The parser
+   * only issues this once the queue has drained, and no more is accepted
+   * until the park has run and its position is adopted.
+   */
+  void park()
+  {
+    queueMove(BLOCK_PARK, _position[0], _position[1], _machine->penHeight(false),
+              _position[3], _position[4], _position[5]);
+    _parking = true;
+  }
+
+  // The planned position is where the last queued block ends.
+  float getX() { return _position[0]; }
+  float getY() { return _position[1]; }
+  float getZ() { return _position[2]; }
+  float getA() { return _position[3]; }
+  float getB() { return _position[4]; }
+  float getC() { return _position[5]; }
+
+  /**
+   * setFeedrate - records the feed rate for blocks queued after this call.
+   */
+  void setFeedrate(float f)
+  {
+    if (f > 0)
+    {
+      _feedrate = f;
+    }
+  }
+
+  /**
+   * setAcceleration - changes the acceleration limit in mm/s^2 and the
+   * junction deviation in mm for blocks queued after this call.
+   */
+  void setAcceleration(float acceleration, float junctionDeviation)
+  {
+    _acceleration = acceleration;
+    _junctionDeviation = junctionDeviation;
+  }
+
+  /**
+   * setHome - passed directly to the machine, as the parser only issues this
+   * once the queue has drained.
+   */
+  void setHome(float x, float y, float z, float a, float b, float c)
+  {
+    _machine->setHome(x, y, z, a, b, c);
+    syncPosition();
+  }
+
+  void setPosition(float x, float y, float z, float a, float b, float c)
+  {
+    queueMove(BLOCK_RAPID, x, y, z, a, b, c);
+  }
+
+  void movePosition(float x, float y, float z, float a, float b, float c)
+  {
+    queueMove(BLOCK_LINEAR, x, y, z, a, b, c);
+  }
+
+  void dwell(float seconds)
+  {
+    queueCommand(BLOCK_DWELL, seconds);
+  }
+
+  /**
+   * enableVacuum - lowers or raises the pen to the machine's heights for
+   * them, in order with the moves.
+   */
+  void enableVacuum(boolean enable)
+  {
+    queueMove(BLOCK_RAPID, _position[0], _position[1], _machine->penHeight(enable),
+              _position[3], _position[4], _position[5]);
+  }
+
+  boolean ready()
+  {
+    return !isFull() && !_parking;
+  }
+
+  boolean idle()
+  {
+    return isEmpty();
+  }
+
+  /**
+   * Discards the queued blocks, for a soft reset once the executor has been
+   * stopped, and adopts the machine's position where it stopped.
+   */
+  void clear()
+  {
+    _tail = _head;
+    _busy = false;
+    _parking = false;
+    _previousSpeed = 0;
+    syncPosition();
+  }
+
+  /**
+   * Number of blocks queued, including the one executing.
+   */
+  byte queued()
+  {
+    return (_head + BLOCK_BUFFER_SIZE - _tail) % BLOCK_BUFFER_SIZE;
+  }
+
+  boolean isEmpty()
+  {
+    return _head == _tail;
+  }
+
+  boolean isFull()
+  {
+    return nextIndex(_head) == _tail;
+  }
+
+  /**
+   * Returns the oldest queued block, or NULL when the queue is empty. The
+   * block stays queued until discardCurrentBlock is called.
+   */
+  MotionBlock * currentBlock()
+  {
+    if (isEmpty())
+    {
+      return NULL;
+    }
+    return &_blocks[_tail];
+  }
+
+  /**
+   * Returns the block queued after the current one, or NULL if there is
+   * none yet.
+   */
+  MotionBlock * nextBlock()
+  {
+    byte next = nextIndex(_tail);
+    if (isEmpty() || next == _head)
+    {
+      return NULL;
+    }
+    return &_blocks[next];
+  }
+
+  /**
+   * Marks the current block as executing and commits to the speed it will
+   * exit at, which later planning can no longer change.
+   * @return the exit speed in mm/s.
+   */
+  float beginCurrentBlock()
+  {
+    _busy = true;
+    _exitSpeed = 0;
+
+    byte next = nextIndex(_tail);
+    if (next != _head && _blocks[next].type == BLOCK_LINEAR)
+    {
+      _exitSpeed = _blocks[next].entrySpeed;
+    }
+    return _exitSpeed;
+  }
+
+  /**
+   * Releases the oldest block once it has been executed, and adopts the
+   * machine's position once it has parked.
+   */
+  void discardCurrentBlock()
+  {
+    if (!isEmpty())
+    {
+      if (_blocks[_tail].type == BLOCK_PARK)
+      {
+        _parking = false;
+        syncPosition();
+      }
+      _tail = nextIndex(_tail);
+      _busy = false;
+    }
+  }
+
+private:
+  GCodeProcessor * _machine;
+  MotionBlock _blocks[BLOCK_BUFFER_SIZE];
+  byte _head;   // index where the next block is stored.
+  byte _tail;   // index of the block being executed.
+
+  // True once the executor has started the tail block, whose exit speed
+  // is then fixed.
+  boolean _busy;
+  float _exitSpeed;
+
+  // True while a park is queued, whose position is not known until it runs.
+  boolean _parking;
+
+  // Position at the end of the last queued block.
+  float _position[NUM_AXES];
+
+  // Feed rate for new blocks in mm/min.
+  float _feedrate;
+
+  float _acceleration;
+  float _junctionDeviation;
+
+  // Direction and nominal speed of the last queued linear block. The speed
+  // is zero when the arm must stop before the next block.
+  float _previousUnit[3];
+  float _previousSpeed;
+
+  byte nextIndex(byte index)
+  {
+    return (index + 1) % BLOCK_BUFFER_SIZE;
+  }
+
+  byte prevIndex(byte index)
+  {
+    return (index + BLOCK_BUFFER_SIZE - 1) % BLOCK_BUFFER_SIZE;
+  }
+
+  /**
+   * Copies the machine's current position into the planned position.
+   */
+  void syncPosition()
+  {
+    _position[0] = _machine->getX();
+    _position[1] = _machine->getY();
+    _position[2] = _machine->getZ();
+    _position[3] = _machine->getA();
+    _position[4] = _machine->getB();
+    _position[5] = _machine->getC();
+  }
+
+  /**
+   * Stores a move in the queue and advances the planned position. Callers
+   * check ready() first, and a move which would overrun a full queue is
+   * refused rather than written over the blocks still to execute.
+   */
+  void queueMove(byte type, float x, float y, float z, float a, float b, float c)
+  {
+    if (isFull())
+    {
+      return;
+    }
+    MotionBlock *block = &_blocks[_head];
+    block->type = type;
+    block->target[0] = x;
+    block->target[1] = y;
+    block->target[2] = z;
+    block->target[3] = a;
+    block->target[4] = b;
+    block->target[5] = c;
+    block->feedrate = _feedrate;
+
+    if (type == BLOCK_LINEAR)
+    {
+      prepareLinear(block);
+    }
+    else
+    {
+      _previousSpeed = 0;
+    }
+
+    for (int i = 0; i < NUM_AXES; i++)
+    {
+      _position[i] = block->target[i];
+    }
+    _head = nextIndex(_head);
+
+    recalculate();
+  }
+
+  /**
+   * Stores a non-motion command so it executes in order with the moves.
+   */
+  void queueCommand(byte type, float value)
+  {
+    if (isFull())
+    {
+      return;
+    }
+    MotionBlock *block = &_blocks[_head];
+    block->type = type;
+    block->target[0] = value;
+    block->feedrate = _feedrate;
+    _previousSpeed = 0;
+    _head = nextIndex(_head);
+
+    recalculate();
+  }
+
+  /**
+   * Computes the length and speed limits of a linear block which starts at
+   * the planned position. The length is in X and Y, as Z moves the pen
+   * before the block does.
+   */
+  void prepareLinear(MotionBlock *block)
+  {
+    float unit[3] = { 0, 0, 0 };
+    float sumSq = 0;
+    for (int i = 0; i < 2; i++)
+    {
+      unit[i] = block->target[i] - _position[i];
+      sumSq += unit[i] * unit[i];
+    }
+    if (block->target[2] != _position[2])
+    {
+      // Stop for the pen.
+      _previousSpeed = 0;
+    }
+    block->millimeters = sqrt(sumSq);
+    block->nominalSpeed = block->feedrate / 60;
+#ifdef S_CURVE_ACCELERATION
+    // Plan with the average acceleration of the S-curve ramp.
+    block->acceleration = _acceleration * 2 / 3;
+#else
+    block->acceleration = _acceleration;
+#endif
+
+    // The joints may not keep up with the feed everywhere in the work area.
+    _machine->limitMove(_position, block->target, &block->nominalSpeed, &block->acceleration);
+
+    if (block->millimeters == 0)
+    {
+      block->maxEntrySpeed = 0;
+      block->entrySpeed = 0;
+      return;
+    }
+
+    for (int i = 0; i < 2; i++)
+    {
+      unit[i] /= block->millimeters;
+    }
+
+    // Limit the junction speed so the tool follows a circle which stays
+    // within the junction deviation of the corner, with centripetal
+    // acceleration no greater than the acceleration limit.
+    float vmax = 0;
+    if (_previousSpeed > 0)
+    {
+      float cosTheta = -(_previousUnit[0] * unit[0] + _previousUnit[1] * unit[1] + _previousUnit[2] * unit[2]);
+      if (cosTheta < 0.95)
+      {
+        vmax = min(_previousSpeed, block->nominalSpeed);
+        if (cosTheta > -0.95)
+        {
+          float sinThetaD2 = sqrt(0.5 * (1.0 - cosTheta));
+          vmax = min(vmax, sqrt(block->acceleration * _junctionDeviation * sinThetaD2 / (1.0 - sinThetaD2)));
+        }
+      }
+    }
+    block->maxEntrySpeed = vmax;
+    block->entrySpeed = vmax;
+
+    for (int i = 0; i < 3; i++)
+    {
+      _previousUnit[i] = unit[i];
+    }
+    _previousSpeed = block->nominalSpeed;
+  }
+
+  /**
+   * Recomputes entry speeds across the queue. The reverse pass makes sure
+   * every block can decelerate to the next one's entry, with the newest block
+   * ending at rest. The forward pass makes sure every entry can be reached by
+   * accelerating through the block before it. A busy block is left alone, and
+   * the block after it enters at the exit speed it committed to.
+   */
+  void recalculate()
+  {
+    byte first = _busy ? nextIndex(_tail) : _tail;
+    if (first == _head)
+    {
+      return;
+    }
+
+    float nextEntry = 0;
+    byte i = _head;
+    do
+    {
+      i = prevIndex(i);
+      MotionBlock *block = &_blocks[i];
+      if (block->type == BLOCK_LINEAR)
+      {
+        block->entrySpeed = min(block->maxEntrySpeed,
+          sqrt(nextEntry * nextEntry + 2 * block->acceleration * block->millimeters));
+        nextEntry = block->entrySpeed;
+      }
+      else
+      {
+        nextEntry = 0;
+      }
+    }
+    while (i != first);
+
+    float reachable = _busy ? _exitSpeed : 0;
+    for (i = first; i != _head; i = nextIndex(i))
+    {
+      MotionBlock *block = &_blocks[i];
+      if (block->type == BLOCK_LINEAR)
+      {
+        block->entrySpeed = min(block->entrySpeed, reachable);
+        reachable = sqrt(block->entrySpeed * block->entrySpeed + 2 * block->acceleration * block->millimeters);
+      }
+      else
+      {
+        reachable = 0;
+      }
+    }
+  }
+};
+
+#endif  // Planner_H
+
+//------------------------------------------------------------------------------
+// Copyright (C) 2015 Martin Heermance (mheermance@gmail.com)
+/*
+┌──────────────────────────────────────────────────────────────────────────┐
+│                                                   TERMS OF USE: MIT License                                                   │
+├──────────────────────────────────────────────────────────────────────────┤
+│Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation     │
+│files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,     │
+│modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software │
+│is furnished to do so, subject to the following conditions:                                                                    │
+│                                                                                                                               │
+│The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. │
+│                                                                                                                               │
+│THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE           │
+│WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR          │
+│COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,    │
+│ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                          │
+└──────────────────────────────────────────────────────────────────────────┘
+*/
+
@@ -0,0 +1,173 @@
+//------------------------------------------------------------------------------
+// PolarArm class - kinematics for a polar plotter. Its arm turns about the
+// pillar and the pen rides a slide along the arm, driven by a servo through
+// a rack and pinion. It is the second machine the planner and executor can
+// drive, selected by POLAR_PLOTTER in the sketch. As with ScaraArm the
+// geometry is given by template parameters, so it folds into the kinematics.
+//------------------------------------------------------------------------------
+// Copyright at end of file.
+
+#ifndef PolarArm_H
+#define PolarArm_H
+
+#include "Parser.h"
+#include "Joint.h"
+#ifdef PERF_COUNTERS
+#include "PerfCounters.h"
+#endif
+
+// Reach of the pen from the pillar is InnerReach to OuterReach in mm, and
+// PinionRadius is the pitch radius of the slide servo's pinion in mm.
+template <int InnerReach, int OuterReach, int PinionRadius>
+class PolarArm final : public GCodeProcessor
+{
+public:
+  // Joints hold the position, but also require setting scaling parameters.
+  // The turn joint is zero with the arm pointing straight out along Y and
+  // counter clockwise is positive. The slide joint is the pinion's angle,
+  // which is zero with the pen halfway along its travel.
+  Joint _turn;
+  Joint _slide;
+
+private:
+  // Reach at the middle of the slide's travel.
+  static constexpr float MIDDLE_REACH = (InnerReach + OuterReach) / 2.0;
+
+  // Coordinate of the pen tip in mm.
+  float _x;
+  float _y;
+
+  // Offset of the work surface origin from the pillar.
+  float _xOffset;
+  float _yOffset;
+
+public:
+  /**
+   * Constructor used to initialize arm parameters.
+   * @param xOffset - amount to move coordinates away from pillar.
+   * @param yOffset - amount to move away from the pillar.
+   */
+  PolarArm(int xOffset, int yOffset)
+  {
+    _x = 0;
+    _y = 0;
+    _xOffset = xOffset;
+    _yOffset = yOffset;
+  }
+
+  /**
+   * Park - moves the pen straight out from the pillar to the middle of its
+   * travel, where both servos are centered.
+   */
+  void park()
+  {
+    setPosition(-_xOffset, MIDDLE_REACH - _yOffset, 0, 0, 0, 0);
+  }
+
+  /**
+   * setFeedrate - unused as the Executor times the interpolated points.
+   */
+  void setFeedrate(float f)
+  {
+  }
+
+  /**
+   * setHome - used to set a location as the origin for future calculations.
+   */
+  void setHome(float x, float y, float z, float a, float b, float c)
+  {
+    _xOffset = x;
+    _yOffset = y;
+  }
+
+  /**
+   * setPosition - positions the pen. Points out of reach are ignored.
+   */
+  void setPosition(float x, float y, float z, float a, float b, float c)
+  {
+    _x = x;
+    _y = y;
+
+    float turn, slide;
+    if (solve(x + _xOffset, y + _yOffset, &turn, &slide))
+    {
+      _turn.setPosition(turn);
+      _slide.setPosition(slide);
+      _turn.commit();
+      _slide.commit();
+    }
+#ifdef PERF_COUNTERS
+    else
+    {
+      perf.rejections++;
+    }
+#endif
+  }
+
+  /**
+   * movePosition - places the pen directly at the target. Linear interpolation
+   * is performed by the Executor, which positions the arm one step per tick.
+   */
+  void movePosition(float x, float y, float z, float a, float b, float c)
+  {
+    setPosition(x, y, z, a, b, c);
+  }
+
+  /**
+   * solve : finds the joint angles which put the pen at a point relative to
+   * the pillar.
+   * @param x - the side to side displacement in mm.
+   * @param y - the distance out from the pillar in mm.
+   * @param turn - receives the arm's angle in radians.
+   * @param slide - receives the pinion's angle in radians.
+   * @return false if the point is out of reach.
+   */
+  boolean solve(float x, float y, float *turn, float *slide)
+  {
+#ifdef PERF_COUNTERS
+    perf.solves++;
+#endif
+    float reach = sqrt(x * x + y * y);
+    if (reach < InnerReach || reach > OuterReach)
+    {
+      return false;
+    }
+    *turn = atan2(-x, y);
+    *slide = (reach - MIDDLE_REACH) / PinionRadius;
+    return true;
+  }
+
+  float getX() { return _x; }
+  float getY() { return _y; }
+
+  // unused gcode parser callbacks.
+  float getZ() { return 0; }
+  float getA() { return 0; }
+  float getB() { return 0; }
+  float getC() { return 0; }
+
+  void enableVacuum(boolean enable)
+  {
+  }
+};
+
+#endif  // PolarArm_H
+
+/*
+┌──────────────────────────────────────────────────────────────────────────┐
+│                                                   TERMS OF USE: MIT License                                                   │
+├──────────────────────────────────────────────────────────────────────────┤
+│Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation     │
+│files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,     │
+│modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software │
+│is furnished to do so, subject to the following conditions:                                                                    │
+│                                                                                                                               │
+│The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. │
+│                                                                                                                               │
+│THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE           │
+│WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR          │
+│COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,    │
+│ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                          │
+└──────────────────────────────────────────────────────────────────────────┘
+*/
+
@@ -0,0 +1,278 @@
+//------------------------------------------------------------------------------
+// PulseEngine class - generates the joint servo pulses from Timer1 in place
+// of the Servo library. Pulse widths are double buffered: joints set pending
+// widths and commit them, and the interrupt only takes a committed set at the
+// start of a frame, so each frame carries all of the old widths or all of the
+// new ones. The timer counts half microseconds and the frame length can be
+// changed from the standard 20 ms.
+//
+// The Servo library also drives Timer1, so the two cannot be linked together.
+// Define PULSE_ENGINE in the sketch to use this instead.
+//------------------------------------------------------------------------------
+// Copyright at end of file.
+
+#ifndef PulseEngine_H
+#define PulseEngine_H
+
+// Timer ticks per microsecond, with Timer1 running at clk/8.
+#define PULSE_TICKS_PER_MICRO 2
+
+// Default frame length, the usual 50 Hz servo refresh. At most 32767 us.
+#ifndef PULSE_FRAME_MICROS
+#define PULSE_FRAME_MICROS 20000
+#endif
+
+// Number of servos driven, one pulse after the other in each frame. The
+// pulses must fit in the frame.
+#ifndef PULSE_CHANNELS
+#define PULSE_CHANNELS 2
+#endif
+
+class PulseEngine;
+
+// The engine serviced by the timer interrupt.
+static PulseEngine *activePulseEngine = NULL;
+
+class PulseEngine
+{
+public:
+  PulseEngine()
+  {
+    _count = 0;
+    _channel = -1;
+    _elapsed = 0;
+    _swap = false;
+    _frames = 0;
+  }
+
+  /**
+   * attach - assigns the next channel to a servo's pin.
+   * @param pin - the pin driving the servo.
+   * @param minMicros - shortest pulse, narrower ones are clamped.
+   * @param maxMicros - longest pulse, wider ones are clamped.
+   * @return the channel number, or -1 if every channel is in use.
+   */
+  int attach(byte pin, int minMicros, int maxMicros)
+  {
+    if (_count >= PULSE_CHANNELS)
+    {
+      return -1;
+    }
+
+    byte channel = _count++;
+    _pins[channel] = pin;
+    _min[channel] = minMicros * PULSE_TICKS_PER_MICRO;
+    _max[channel] = maxMicros * PULSE_TICKS_PER_MICRO;
+    _pending[channel] = (_min[channel] + _max[channel]) / 2;
+    _committed[channel] = _pending[channel];
+    _active[channel] = _pending[channel];
+    pinMode(pin, OUTPUT);
+#ifdef __AVR__
+    _ports[channel] = portOutputRegister(digitalPinToPort(pin));
+    _masks[channel] = digitalPinToBitMask(pin);
+#endif
+    return channel;
+  }
+
+  /**
+   * begin - starts generating frames.
+   * @param frameMicros - frame length, which must exceed the longest pulses
+   *   of all the channels together.
+   */
+  void begin(unsigned long frameMicros = PULSE_FRAME_MICROS)
+  {
+    _frameTicks = frameMicros * PULSE_TICKS_PER_MICRO;
+    activePulseEngine = this;
+#ifdef __AVR__
+    noInterrupts();
+    TCCR1A = 0;
+    TCCR1B = _BV(WGM12) | _BV(CS11);   // CTC mode, clk/8
+    TCNT1 = 0;
+    OCR1A = _frameTicks - 1;
+    TIFR1 = _BV(OCF1A);
+    TIMSK1 = _BV(OCIE1A);
+    interrupts();
+#else
+    simTimerStart(pulseEngineInterrupt, 1000 / PULSE_TICKS_PER_MICRO);
+    simTimerSchedule(_frameTicks);
+#endif
+  }
+
+  /**
+   * setPulse - sets a channel's pending pulse width, which is output from
+   * the frame after it is committed.
+   * @param channel - the channel returned by attach.
+   * @param micros - the width, with a resolution of half a microsecond.
+   */
+  void setPulse(byte channel, float micros)
+  {
+    long ticks = lround(micros * PULSE_TICKS_PER_MICRO);
+    _pending[channel] = constrain(ticks, (long)_min[channel], (long)_max[channel]);
+  }
+
+  /**
+   * getPulse - returns a channel's pending pulse width in microseconds.
+   */
+  float getPulse(byte channel)
+  {
+    return (float)_pending[channel] / PULSE_TICKS_PER_MICRO;
+  }
+
+  /**
+   * commit - hands the pending widths of every channel to the interrupt,
+   * which starts them together at the next frame.
+   */
+  void commit()
+  {
+    noInterrupts();
+    for (byte i = 0; i < _count; i++)
+    {
+      _committed[i] = _pending[i];
+    }
+    _swap = true;
+    interrupts();
+  }
+
+  /**
+   * frames - returns the number of frames started.
+   */
+  unsigned long frames()
+  {
+    noInterrupts();
+    unsigned long frames = _frames;
+    interrupts();
+    return frames;
+  }
+
+  /**
+   * onCompare - ends the current pulse and starts the next one, or waits
+   * out the rest of the frame. Called from the timer interrupt.
+   */
+  void onCompare()
+  {
+    if (_channel >= 0)
+    {
+      setPin(_channel, false);
+    }
+    _channel++;
+
+    if (_channel == _count)
+    {
+      // All pulses are out, so idle until the frame ends.
+      _channel = -1;
+      schedule(_frameTicks - _elapsed);
+      return;
+    }
+
+    if (_channel == 0)
+    {
+      // A new frame takes up any widths committed during the last one.
+      if (_swap)
+      {
+        for (byte i = 0; i < _count; i++)
+        {
+          _active[i] = _committed[i];
+        }
+        _swap = false;
+      }
+      _elapsed = 0;
+      _frames++;
+    }
+
+    setPin(_channel, true);
+    schedule(_active[_channel]);
+    _elapsed += _active[_channel];
+  }
+
+private:
+  byte _count;
+  byte _pins[PULSE_CHANNELS];
+  uint16_t _min[PULSE_CHANNELS];
+  uint16_t _max[PULSE_CHANNELS];
+#ifdef __AVR__
+  volatile uint8_t *_ports[PULSE_CHANNELS];
+  uint8_t _masks[PULSE_CHANNELS];
+#endif
+
+  // Widths in ticks being set, handed to the interrupt, and being output.
+  uint16_t _pending[PULSE_CHANNELS];
+  volatile uint16_t _committed[PULSE_CHANNELS];
+  uint16_t _active[PULSE_CHANNELS];
+  volatile boolean _swap;
+
+  // Channel whose pulse is being output, or -1 between the last pulse and
+  // the end of the frame, and the ticks of the frame used so far.
+  int8_t _channel;
+  uint16_t _elapsed;
+  uint16_t _frameTicks;
+  volatile unsigned long _frames;
+
+  /**
+   * Raises or lowers a channel's pin. Port registers keep this to a couple
+   * of cycles so every edge has the same latency.
+   */
+  void setPin(byte channel, boolean high)
+  {
+#ifdef __AVR__
+    if (high)
+    {
+      *_ports[channel] |= _masks[channel];
+    }
+    else
+    {
+      *_ports[channel] &= ~_masks[channel];
+    }
+#else
+    digitalWrite(_pins[channel], high ? HIGH : LOW);
+#endif
+  }
+
+  /**
+   * Sets the time from this compare match to the next.
+   */
+  void schedule(uint16_t ticks)
+  {
+#ifdef __AVR__
+    // In CTC mode the counter restarted at the match, and counts up to
+    // and including OCR1A.
+    OCR1A = ticks - 1;
+#else
+    simTimerSchedule(ticks);
+#endif
+  }
+
+#ifndef __AVR__
+  static void pulseEngineInterrupt()
+  {
+    activePulseEngine->onCompare();
+  }
+#endif
+};
+
+#ifdef __AVR__
+ISR(TIMER1_COMPA_vect)
+{
+  activePulseEngine->onCompare();
+}
+#endif
+
+#endif  // PulseEngine_H
+
+/*
+┌──────────────────────────────────────────────────────────────────────────┐
+│                                                   TERMS OF USE: MIT License                                                   │
+├──────────────────────────────────────────────────────────────────────────┤
+│Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation     │
+│files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,     │
+│modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software │
+│is furnished to do so, subject to the following conditions:                                                                    │
+│                                                                                                                               │
+│The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. │
+│                                                                                                                               │
+│THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE           │
+│WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR          │
+│COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,    │
+│ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                          │
+└──────────────────────────────────────────────────────────────────────────┘
+*/
+
@@ -3,64 +3,145 @@
 
 #include "Parser.h"
 #include "Joint.h"
-
-class ScaraArm : public GCodeProcessor
+#include "FixedPoint.h"
+#ifdef PERF_COUNTERS
+#include "PerfCounters.h"
+#endif
+
+// Uncomment to solve the inverse kinematics in fixed point rather than soft
+// float. Compared with the float solution over the workspace of the 103/100 mm
+// arm, the elbow angle differs by under 1e-4 radians and the shoulder by under
+// 1e-3 radians, which is half a microsecond of servo pulse and 0.2 mm at the
+// pen. The shoulder error grows to 6e-3 radians within 5 mm of the pillar and
+// 1.7e-3 radians within 1 mm of full reach, where acos is ill conditioned.
+// #define FIXED_POINT_IK
+
+// Fractional bits carried by the pen coordinates, so positions resolve to
+// 1/16 mm rather than being truncated to whole millimeters. The fixed point
+// solution works in the same units, and reach must stay under 256 mm so its
+// squared distances fit in 32 bits.
+#define IK_FRACTION_BITS 4
+#define IK_ONE (1L << IK_FRACTION_BITS)
+
+// Uncomment to answer most positions from the grid of precomputed angles in
+// IKTable.h. The grid must be generated for this arm's humerus and ulna with
+// tools/IKTableGenerator.cpp, otherwise it is ignored. The supplied table uses
+// 8 mm cells and interpolates within 0.002 radians, about 1 microsecond of
+// servo pulse, using just under 6K of flash. At that spacing only about half
+// of the reachable cells interpolate, the rest are solved.
+// #define IK_LOOKUP_TABLE
+
+// Largest distance in mm the pen may stray from a straight move while the
+// joints are interpolated between solved points along it. Where a line is
+// nearly straight in joint space, far from the pillar, long stretches need
+// only one solution at each end.
+#ifndef SEGMENT_TOLERANCE
+#define SEGMENT_TOLERANCE 0.05
+#endif
+
+// Most times a joint space segment is halved to meet the tolerance. The
+// shortest segment is this many halvings of the whole line, so every
+// segment moves the pen along.
+#define SEGMENT_MAX_SPLITS 8
+
+// Spacing in mm of the points along a move where the joint rates are sampled
+// to find the speed the joints can follow, and the most points sampled.
+#define JOINT_SAMPLE_SPACING 5.0
+#define JOINT_MAX_SAMPLES 16
+
+// Classes of grid cells held in the IKTable.h mask.
+#define IK_CELL_UNREACHABLE 0
+#define IK_CELL_SOLVE 1
+#define IK_CELL_INTERPOLATE 2
+
+#ifdef IK_LOOKUP_TABLE
+#include "IKTable.h"
+#endif
+
+// The lengths of the bones are template parameters rather than constructor
+// arguments. They never change on a built arm, and as constants the compiler
+// folds them and their squares into the kinematics.
+template <int Humerus, int Ulna>
+class ScaraArm final : public GCodeProcessor
 {
 public:
   // Angular values for common angles
-  static const float STEP_ANGLE      = PI / 360;
-  static const float RIGHT_ANGLE     = PI / 2;
-  static const float STRAIGHT_ANGLE  = PI;
-  static const float FULL_ROTATION   = 2.0 * PI;
+  static constexpr float STEP_ANGLE      = PI / 360;
+  static constexpr float RIGHT_ANGLE     = PI / 2;
+  static constexpr float STRAIGHT_ANGLE  = PI;
+  static constexpr float FULL_ROTATION   = 2.0 * PI;
   
-  static const float DEG2RAD         = PI/180.0f;
-  static const float RAD2DEG         = 180.0f/PI;
+  static constexpr float DEG2RAD         = PI/180.0f;
+  static constexpr float RAD2DEG         = 180.0f/PI;
   
   // Joints hold the position, but also require setting scalling parameters.
   Joint _shoulder;
   Joint _elbow;
 
+  // Lifts the pen. Its position is the pen's height in mm rather than an
+  // angle, so its scale is in microseconds per mm.
+  Joint _pen;
+
 private:
 
   // Size of robot bones in consistent units (mm recommended).
-  int _humerus;
-  int _ulna;
-  int _humerusSq;
-  int _ulnaSq;
+  static constexpr int _humerus = Humerus;
+  static constexpr int _ulna = Ulna;
+  static constexpr int _humerusSq = Humerus * Humerus;
+  static constexpr int _ulnaSq = Ulna * Ulna;
 
-  // Coordinate of pen tip in Cartesian space.
-  int _x, _y;
+  // Coordinate of pen tip in Cartesian space, in IK_FRACTION_BITS fixed point.
+  int32_t _x, _y;
 
   // Scara arms don't work well close to the origin. It's best to offset the
   // work surface origin away from the pillar the arm is resting upon.
-  int _xOffset;
-  int _yOffset;
-  
-  // Feed rate delay.
-  int _feedRateDelay;
+  int32_t _xOffset;
+  int32_t _yOffset;
+
+  // Straight move being followed, which starts at _lineX, _lineY relative to
+  // the pillar and runs by _lineDX, _lineDY. Joint angles are interpolated
+  // across the part of it between fractions _segmentStart and _segmentEnd.
+  boolean _lineActive;
+  float _lineX;
+  float _lineY;
+  float _lineDX;
+  float _lineDY;
+  float _lineLengthSq;
+  float _segmentStart;
+  float _segmentEnd;
+  float _shoulderStart;
+  float _elbowStart;
+  float _shoulderEnd;
+  float _elbowEnd;
+
+  // True when the pen was last placed at the end of the line, so the next
+  // line starts from the known angles of its last segment.
+  boolean _lineEnded;
+
+  // Height the pen was sent to, where it is raised and lowered to by M11
+  // and M10, and the seconds it takes to move between them. Z = 0 is the
+  // paper.
+  float _z;
+  float _penUp;
+  float _penDown;
+  float _penSeconds;
 
 public:
   /**
    * Constructor used to initialize arm parameters.
-   * @param humerus - shoulder-to-elbow "bone" in mm
-   * @param ulna - elbow-to-wrist "bone" in mm
    * @param xOffset - amount to move coordinates away from pillar.
    * @param yOffset - amount to move away from the pillar.
-   * @param feedRateDelay - amount of milliseconds to pause.
    */
-  ScaraArm(int humerus, int ulna, int xOffset, int yOffset, int feedRateDelay)
+  ScaraArm(int xOffset, int yOffset)
   {
-    _humerus = humerus;
-    _ulna = ulna;
-
-    /* pre-calculations */
-    _humerusSq = _humerus * _humerus;
-    _ulnaSq = _ulna * _ulna;
-    
-    _xOffset = xOffset;
-    _yOffset = yOffset;
-    
-    _feedRateDelay = feedRateDelay;
+    _xOffset = (int32_t)xOffset << IK_FRACTION_BITS;
+    _yOffset = (int32_t)yOffset << IK_FRACTION_BITS;
+    _lineActive = false;
+    _lineEnded = false;
+    _z = 0;
+    _penUp = 0;
+    _penDown = 0;
+    _penSeconds = 0;
   }
 
   /**
@@ -70,17 +151,62 @@ public:
    */
   void park()
   {
+    movePen(_penUp);
     setPosition(50, 50);
   }
+
+  /**
+   * setPenLimits - sets where the pen is raised and lowered to, and how
+   * long its servo takes to move between them.
+   * @param up - height of the raised pen in mm.
+   * @param down - height of the lowered pen in mm, at or below the paper.
+   * @param seconds - time to move from one to the other, including settling.
+   */
+  void setPenLimits(float up, float down, float seconds)
+  {
+    _penUp = up;
+    _penDown = down;
+    _penSeconds = seconds;
+  }
+
+  /**
+   * movePen - sends the pen servo to a height, kept within the raised and
+   * lowered heights. Z is remembered as given, so it matches the planner.
+   */
+  void movePen(float z)
+  {
+    _z = z;
+    _pen.setPosition(constrain(z, _penDown, _penUp));
+    _pen.commit();
+  }
+
+  /**
+   * penSeconds - the pen servo is taken to move at an even speed, so the
+   * time is in proportion to the distance to the height.
+   */
+  float penSeconds(float from, float to, float height)
+  {
+    float range = _penUp - _penDown;
+    if (range <= 0)
+    {
+      return 0;
+    }
+    from = constrain(from, _penDown, _penUp);
+    to = constrain(to, _penDown, _penUp);
+    height = constrain(height, min(from, to), max(from, to));
+    return _penSeconds * fabs(height - from) / range;
+  }
+
+  float penHeight(boolean down)
+  {
+    return down ? _penDown : _penUp;
+  }
   
   /**
-   * setFeedrate - used to set the number of interpolated points which effects
-   * servo ramping speed.
+   * setFeedrate - unused as the Executor times the interpolated points.
    */
   void setFeedrate(float f)
   {
-    // delay ms/mm = Constant ms/min / feedrate mm/min
-    _feedRateDelay = f/60000; 
   }
   
   /**
@@ -89,63 +215,414 @@ public:
    */
   void setHome(float x, float y, float z, float a, float b, float c)
   {
-    _xOffset = (int)x;
-    _yOffset = (int)y;
+    _xOffset = toFixed(x);
+    _yOffset = toFixed(y);
+    _lineActive = false;
   }
 
   /**
-   * setPosition : Arm positioning routine utilizing inverse kinematics.  Since the arm
-   * is resting on a surface Z can only be positive.  Servo movement constraints prevent
-   * y from being negative, But X can be a signed value.
-   * Note: This must be called before and of the move routines to initialize arm state.
+   * setPosition : positions the arm at whole millimeter coordinates.
    * @param x - the side to side displacement.
    * @param y - the distance out from the base center.
    */
   void setPosition( int x, int y )
+  {
+    setFixedPosition((int32_t)x << IK_FRACTION_BITS, (int32_t)y << IK_FRACTION_BITS);
+  }
+
+  /**
+   * setFixedPosition : Arm positioning routine utilizing inverse kinematics.  Since the arm
+   * is resting on a surface Z can only be positive.  Servo movement constraints prevent
+   * y from being negative, But X can be a signed value.
+   * Note: This must be called before and of the move routines to initialize arm state.
+   * @param x - the side to side displacement in IK_FRACTION_BITS fixed point.
+   * @param y - the distance out from the base center in IK_FRACTION_BITS fixed point.
+   */
+  void setFixedPosition( int32_t x, int32_t y )
   {
     // Save the Cartesian space coordinates.
     _x = x;
     _y = y;
+    _lineActive = false;
     
     // Move the origin by the offset.
-    x = x + _xOffset;
-    y = y + _yOffset;
+    float shoulderRads, elb_angle_r;
+    if (solve(x + _xOffset, y + _yOffset, &shoulderRads, &elb_angle_r))
+    {
+      // Set the joints
+      setJoints(shoulderRads, elb_angle_r);
+    }
+#ifdef PERF_COUNTERS
+    else
+    {
+      perf.rejections++;
+    }
+#endif
+  }
+
+  /**
+   * solve : finds the joint angles which put the pen at a point relative to
+   * the pillar, as they are passed to setShoulder and setElbow.
+   * @param x - the side to side displacement in IK_FRACTION_BITS fixed point.
+   * @param y - the distance out from the pillar in IK_FRACTION_BITS fixed point.
+   * @param shoulder - receives the shoulder angle in radians.
+   * @param elbow - receives the elbow angle in radians.
+   * @return false if the point is out of reach.
+   */
+  boolean solve(int32_t x, int32_t y, float *shoulder, float *elbow)
+  {
+#ifdef PERF_COUNTERS
+    perf.solves++;
+#endif
+
+#ifdef IK_LOOKUP_TABLE
+    // Most of the workspace is answered from the grid, cells near the pillar
+    // and at full reach fall through to solving the kinematics.
+    switch (lookupAngles(x, y, shoulder, elbow))
+    {
+    case IK_CELL_UNREACHABLE:
+      return false;
+    case IK_CELL_INTERPOLATE:
+      return true;
+    }
+#endif
+
+#ifdef FIXED_POINT_IK
+    int32_t fixedShoulder, fixedElbow;
+    if (!solveFixed(x, y, &fixedShoulder, &fixedElbow))
+    {
+      return false;
+    }
+    *shoulder = fixedToRadians(fixedShoulder);
+    *elbow = fixedToRadians(fixedElbow);
+    return true;
+#else
+    float fx = x * (1.0 / IK_ONE);
+    float fy = y * (1.0 / IK_ONE);
 
     // Use Pythagorean theorem to calculate shoulder to wrist distance.
-    int s_w = ( x * x ) + ( y * y );
+    float s_w = ( fx * fx ) + ( fy * fy );
     float s_w_sqrt = sqrt( s_w );
 
     // s_w angle to centerline
-    float a1 = atan2( y, x );
+    float a1 = atan2( fy, fx );
 
     // s_w angle to humerus.
-    float q = (float)(_humerusSq - _ulnaSq + s_w) / (2.0 * _humerus * s_w_sqrt);
+    float q = (_humerusSq - _ulnaSq + s_w) / (2.0 * _humerus * s_w_sqrt);
 
     // if > 1 or < -1 the result would be NAN which means point is out of range.
     if (q > 1 || q < -1)
     {
-      return;
+      return false;
     }
 
     float a2 = acos(q);
 
     // shoulder angle. Note there are two solutions for a right or
     // left arm.  We're using the solution for the right arm.
-    float shoulderRads = a1 - a2;
-
-    // Set the shoulder angle.
-    setShoulder(shoulderRads);
+    *shoulder = a1 - a2;
 
     // elbow angle
-    float elb_angle_r = acos((float)(_humerusSq + _ulnaSq - s_w) / ( 2.0 * _humerus * _ulna ));
+    float elb_angle_r = acos((_humerusSq + _ulnaSq - s_w) / ( 2.0 * _humerus * _ulna ));
 
     // Right arm solution requires coordinate rotation to use oblique (or negative) elbow angles.
-    elb_angle_r = FULL_ROTATION - elb_angle_r;
+    *elbow = FULL_ROTATION - elb_angle_r;
+    return true;
+#endif
+  }
+
+  /**
+   * limitMove : lowers the speed and acceleration of a straight move so that
+   * neither joint exceeds its limits. Joint angles are solved at points along
+   * the move, and differencing them gives each joint's rotation per mm and
+   * its change per mm. A joint turning w radians per mm limits the speed to
+   * maxVelocity / w and the acceleration to maxAcceleration / w, and a rate
+   * changing by c radians per mm^2 limits the speed to
+   * sqrt(maxAcceleration / c). Moves leaving the arm's reach are unchanged.
+   */
+  void limitMove(const float *start, const float *target, float *speed, float *acceleration)
+  {
+    float dx = target[0] - start[0];
+    float dy = target[1] - start[1];
+    float length = sqrt(dx * dx + dy * dy);
+    if (length == 0)
+    {
+      return;
+    }
+
+    int samples = constrain((int)ceil(length / JOINT_SAMPLE_SPACING), 2, JOINT_MAX_SAMPLES);
+    float spacing = length / samples;
+    float angles[2], last[2], lastRate[2];
+    float maxRate[2] = { 0, 0 };
+    float maxChange[2] = { 0, 0 };
+    for (int i = 0; i <= samples; i++)
+    {
+      float f = (float)i / samples;
+      if (!solve(toFixed(start[0] + dx * f) + _xOffset, toFixed(start[1] + dy * f) + _yOffset,
+                 &angles[0], &angles[1]))
+      {
+        return;
+      }
+
+      for (int j = 0; i > 0 && j < 2; j++)
+      {
+        float rate = (angles[j] - last[j]) / spacing;
+        maxRate[j] = max(maxRate[j], fabs(rate));
+        if (i > 1)
+        {
+          maxChange[j] = max(maxChange[j], fabs(rate - lastRate[j]) / spacing);
+        }
+        lastRate[j] = rate;
+      }
+      last[0] = angles[0];
+      last[1] = angles[1];
+    }
+
+    Joint *joints[2] = { &_shoulder, &_elbow };
+    for (int j = 0; j < 2; j++)
+    {
+      float maxVelocity = joints[j]->getMaxVelocity();
+      float maxAcceleration = joints[j]->getMaxAcceleration();
+      if (maxVelocity > 0 && maxRate[j] > 0)
+      {
+        *speed = min(*speed, maxVelocity / maxRate[j]);
+      }
+      if (maxAcceleration > 0)
+      {
+        if (maxRate[j] > 0)
+        {
+          *acceleration = min(*acceleration, maxAcceleration / maxRate[j]);
+        }
+        if (maxChange[j] > 0)
+        {
+          *speed = min(*speed, sqrt(maxAcceleration / maxChange[j]));
+        }
+      }
+    }
+  }
+
+  /**
+   * followLine : positions the pen at a point of the line being followed by
+   * interpolating the joint angles of the segment which holds it.
+   * @return false if the point is not on the rest of the line, which the
+   *   caller then solves directly.
+   */
+  boolean followLine(float x, float y)
+  {
+    // Fraction of the way along the line, and distance off it.
+    float px = x + _xOffset * (1.0 / IK_ONE) - _lineX;
+    float py = y + _yOffset * (1.0 / IK_ONE) - _lineY;
+    float f = (px * _lineDX + py * _lineDY) / _lineLengthSq;
+    float ex = px - f * _lineDX;
+    float ey = py - f * _lineDY;
+    if (f < _segmentStart - 1E-4 || f > 1 + 1E-4 || ex * ex + ey * ey > 1E-4)
+    {
+      return false;
+    }
+
+    while (f > _segmentEnd && _segmentEnd < 1)
+    {
+      if (!nextSegment())
+      {
+        return false;
+      }
+    }
 
-    // Set the joints
-    setElbow(elb_angle_r);
+    float u = (f - _segmentStart) / (_segmentEnd - _segmentStart);
+    u = constrain(u, 0, 1);
+    _lineEnded = (_segmentEnd >= 1 && u >= 1);
+    _x = toFixed(x);
+    _y = toFixed(y);
+    setJoints(_shoulderStart + (_shoulderEnd - _shoulderStart) * u,
+              _elbowStart + (_elbowEnd - _elbowStart) * u);
+    return true;
   }
 
+  /**
+   * nextSegment : starts the next joint space segment where the last one
+   * ended, halving it until the pen stays within SEGMENT_TOLERANCE of the
+   * line at its middle.
+   * @return false if the line leaves the arm's reach.
+   */
+  boolean nextSegment()
+  {
+    _segmentStart = _segmentEnd;
+    _shoulderStart = _shoulderEnd;
+    _elbowStart = _elbowEnd;
+
+    const float shortest = 1.0 / (1 << SEGMENT_MAX_SPLITS);
+    float tolerance = SEGMENT_TOLERANCE + solveError();
+    for (float step = 1 - _segmentStart; ; step /= 2)
+    {
+      boolean last = step <= shortest;
+      float end = _segmentStart + step;
+      float shoulder, elbow;
+      float x = _lineX + _lineDX * end;
+      float y = _lineY + _lineDY * end;
+      if (solve(toFixed(x), toFixed(y), &shoulder, &elbow))
+      {
+        // Compare the middle of the joint space segment with the middle of
+        // the straight line.
+        float mid = (_segmentStart + end) / 2;
+        float mx, my;
+        forward((_shoulderStart + shoulder) / 2, (_elbowStart + elbow) / 2, &mx, &my);
+        mx -= _lineX + _lineDX * mid;
+        my -= _lineY + _lineDY * mid;
+        if (last || mx * mx + my * my <= tolerance * tolerance)
+        {
+          _segmentEnd = (step == 1 - _segmentStart) ? 1 : end;
+          _shoulderEnd = shoulder;
+          _elbowEnd = elbow;
+          return true;
+        }
+      }
+      if (last)
+      {
+        return false;
+      }
+    }
+  }
+
+  /**
+   * solveError : how far in mm solve may put the pen from the point asked
+   * for, which no segment can be expected to beat.
+   */
+  float solveError()
+  {
+#ifdef IK_LOOKUP_TABLE
+    // An error in the shoulder angle moves the pen by up to the reach, one
+    // in the elbow angle by up to the ulna.
+    if (_humerus == IK_TABLE_HUMERUS && _ulna == IK_TABLE_ULNA)
+    {
+      return IK_TABLE_ERROR * (_humerus + 2 * _ulna);
+    }
+#endif
+    return 0;
+  }
+
+  /**
+   * forward : the pen position relative to the pillar for joint angles as
+   * passed to setShoulder and setElbow.
+   * @param x - receives the side to side displacement in mm.
+   * @param y - receives the distance out from the pillar in mm.
+   */
+  void forward(float shoulder, float elbow, float *x, float *y)
+  {
+    // The ulna points a straight angle less than the elbow angle away from
+    // the humerus.
+    *x = _humerus * cos(shoulder) - _ulna * cos(shoulder + elbow);
+    *y = _humerus * sin(shoulder) - _ulna * sin(shoulder + elbow);
+  }
+
+  /**
+   * solveFixed : the inverse kinematics of setPosition in fixed point. The law
+   * of cosines gives each angle as acos(adjacent / hypotenuse), which is found
+   * with CORDIC rather than by dividing.
+   * @param x - the side to side displacement from the pillar in fixed point mm.
+   * @param y - the distance out from the pillar in fixed point mm.
+   * @param shoulder - receives the shoulder angle in fixed point radians.
+   * @param elbow - receives the elbow angle in fixed point radians.
+   * @return false if the point is out of reach.
+   */
+  boolean solveFixed(int32_t x, int32_t y, int32_t *shoulder, int32_t *elbow)
+  {
+    // Squared shoulder to wrist distance, with twice the fractional bits.
+    int32_t s_w = x * x + y * y;
+
+    // s_w angle to centerline
+    int32_t a1 = fixedAtan2(y, x, NULL);
+
+    // s_w angle to humerus. The distance gets three more fractional bits
+    // than the coordinates so the ratio stays accurate close to the pillar.
+    int32_t s_w_sqrt = fixedSqrt((uint32_t)s_w << 6);
+    int32_t adjacent = ((((int32_t)_humerusSq - _ulnaSq) << (2 * IK_FRACTION_BITS)) + s_w) << 3;
+    int32_t hypotenuse = 2 * ((int32_t)_humerus << IK_FRACTION_BITS) * s_w_sqrt;
+    int32_t a2;
+    if (!fixedAcos2(adjacent, hypotenuse, &a2))
+    {
+      return false;
+    }
+
+    // shoulder angle using the right arm solution.
+    *shoulder = a1 - a2;
+
+    // elbow angle, rotated to use oblique angles for the right arm.
+    adjacent = (((int32_t)_humerusSq + _ulnaSq) << (2 * IK_FRACTION_BITS)) - s_w;
+    hypotenuse = (2 * (int32_t)_humerus * _ulna) << (2 * IK_FRACTION_BITS);
+    int32_t elb_angle;
+    if (!fixedAcos2(adjacent, hypotenuse, &elb_angle))
+    {
+      return false;
+    }
+    *elbow = FIXED_TWO_PI - elb_angle;
+    return true;
+  }
+
+#ifdef IK_LOOKUP_TABLE
+  /**
+   * lookupAngles : finds the joint angles by bilinear interpolation of the
+   * corners of the grid cell holding the point.
+   * @param x - the side to side displacement from the pillar in fixed point mm.
+   * @param y - the distance out from the pillar in fixed point mm.
+   * @param shoulder - receives the shoulder angle in radians.
+   * @param elbow - receives the elbow angle in radians.
+   * @return the IK_CELL class of the cell, the angles are only set for
+   *   IK_CELL_INTERPOLATE.
+   */
+  byte lookupAngles(int32_t x, int32_t y, float *shoulder, float *elbow)
+  {
+    // Cells are 2^cellBits fixed point units on a side.
+    const int cellBits = IK_TABLE_SPACING_BITS + IK_FRACTION_BITS;
+    const int32_t spacing = 1L << cellBits;
+    int32_t gx = x - ((int32_t)IK_TABLE_X_MIN << IK_FRACTION_BITS);
+    int32_t gy = y;
+    if (_humerus != IK_TABLE_HUMERUS || _ulna != IK_TABLE_ULNA ||
+        gx < 0 || gy < 0 ||
+        gx >= (IK_TABLE_COLUMNS - 1) * spacing || gy >= (IK_TABLE_ROWS - 1) * spacing)
+    {
+      return IK_CELL_SOLVE;
+    }
+
+    int i = gx >> cellBits;
+    int j = gy >> cellBits;
+    int cell = j * (IK_TABLE_COLUMNS - 1) + i;
+    byte kind = (pgm_read_byte(&IK_CELL_MASK[cell / 4]) >> ((cell % 4) * 2)) & 3;
+    if (kind != IK_CELL_INTERPOLATE)
+    {
+      return kind;
+    }
+
+    // Weights of the corners, which sum to spacing^2.
+    int32_t fx = gx & (spacing - 1);
+    int32_t fy = gy & (spacing - 1);
+    int32_t w00 = (spacing - fx) * (spacing - fy);
+    int32_t w10 = fx * (spacing - fy);
+    int32_t w01 = (spacing - fx) * fy;
+    int32_t w11 = fx * fy;
+    int n = j * IK_TABLE_COLUMNS + i;
+
+    const float scale = 1.0 / ((float)IK_TABLE_ANGLE_SCALE * spacing * spacing);
+    *shoulder = scale * interpolate(IK_SHOULDER_TABLE + n, w00, w10, w01, w11);
+
+    // The table holds the elbow as the joint angle, which is a straight
+    // angle less than setElbow expects.
+    *elbow = scale * interpolate(IK_ELBOW_TABLE + n, w00, w10, w01, w11) + STRAIGHT_ANGLE;
+    return IK_CELL_INTERPOLATE;
+  }
+
+  /**
+   * interpolate : weighted sum of the four corners of a grid cell.
+   * @param corner - the cell's lower left corner in a PROGMEM table.
+   */
+  int32_t interpolate(const int16_t *corner, int32_t w00, int32_t w10, int32_t w01, int32_t w11)
+  {
+    return w00 * (int16_t)pgm_read_word(corner)
+      + w10 * (int16_t)pgm_read_word(corner + 1)
+      + w01 * (int16_t)pgm_read_word(corner + IK_TABLE_COLUMNS)
+      + w11 * (int16_t)pgm_read_word(corner + IK_TABLE_COLUMNS + 1);
+  }
+#endif
+
   /**
    * SetY : Arm positioning routine utilizing inverse kinematics.  Moves the arm from
    * the current Y coordinate to the newY passed in.  It maintains all other position
@@ -154,7 +631,7 @@ public:
    */
   void setY(int newY)
   {
-    setPosition(_x, newY);
+    setFixedPosition(_x, (int32_t)newY << IK_FRACTION_BITS);
   }
 
   /**
@@ -165,72 +642,99 @@ public:
    */
   void setX(int newX)
   {
-    setPosition(newX, _y);
+    setFixedPosition((int32_t)newX << IK_FRACTION_BITS, _y);
   }
 
   float getX()
   {
-    return _x;
+    return _x * (1.0 / IK_ONE);
   }
     
   float getY()
   {
-    return _y;
+    return _y * (1.0 / IK_ONE);
   }
 
+  /**
+   * setPosition - positions the pen, rounding to the nearest fixed point unit.
+   * Points along the line begun by beginLine are interpolated in joint space.
+   * The pen's height is left to movePen, which the executor times.
+   */
   void setPosition( float x, float y, float z, float a, float b, float c)
   {
-    setPosition((int)x, (int)y);
-  }
-  
-  void moveY(int y)
-  {
-    int inc = (y > _y) ? 1 : -1;
-    
-    while (_y != y)
+    if (!_lineActive || !followLine(x, y))
     {
-      setPosition(_x, _y + inc);
-      delay(_feedRateDelay);
+      setFixedPosition(toFixed(x), toFixed(y));
     }
   }
-  
-  float getSlope(int x, int y)
+
+  /**
+   * beginLine - prepares to follow a straight move from the current position
+   * to the target, by solving only as many points along it as the segment
+   * tolerance needs.
+   */
+  void beginLine(float x, float y, float z, float a, float b, float c)
   {
-    float deltaY = y - _y;
-    float deltaX = abs(x - _x);
-    
-    return deltaY / deltaX;
+    _lineX = (_x + _xOffset) * (1.0 / IK_ONE);
+    _lineY = (_y + _yOffset) * (1.0 / IK_ONE);
+    _lineDX = x - getX();
+    _lineDY = y - getY();
+    _lineLengthSq = _lineDX * _lineDX + _lineDY * _lineDY;
+    boolean known = _lineActive && _lineEnded;
+    _segmentStart = 0;
+    _segmentEnd = 0;
+    _lineEnded = false;
+    _lineActive = _lineLengthSq > 0 &&
+      (known || solve(_x + _xOffset, _y + _yOffset, &_shoulderEnd, &_elbowEnd)) &&
+      nextSegment();
   }
 
+  /**
+   * toFixed - converts millimeters to IK_FRACTION_BITS fixed point.
+   */
+  static int32_t toFixed(float mm)
+  {
+    return lround(mm * IK_ONE);
+  }
+  
+  /**
+   * movePosition - places the pen directly at the target. Linear interpolation
+   * is performed by the Executor, which positions the arm one step per tick.
+   */
   void movePosition(float x, float y, float z, float a, float b, float c)
   {
-    int xLimit = (int)x;
-    if (xLimit == _x)
-    {
-      moveY((int)y);
-    }
-    else
-    {
-      float slope = getSlope(x, y);
-      int inc = (xLimit > _x) ? 1 : -1;
-      a = _y;
-      while(_x != xLimit)
-      {
-        a += slope;
-        setPosition(_x + inc, a);
-        delay(_feedRateDelay);
-      }
-    }
+    setPosition(x, y, z, a, b, c);
+  }
+
+  float getZ()
+  {
+    return _z;
   }
 
   // unused gcode parser callbacks.
-  float getZ() { return 0; }
   float getA() { return 0; }
   float getB() { return 0; }
   float getC() { return 0; }
 
+  /**
+   * enableVacuum - lowers or raises the pen at once. Queued M10 and M11
+   * reach the arm through movePen instead, so this is for a reset.
+   */
   void enableVacuum(boolean enable)
   {
+    movePen(penHeight(enable));
+  }
+
+  /**
+   * setJoints: sets both joint angles and commits them, so with the pulse
+   * engine the shoulder and elbow change in the same servo frame.
+   */
+  void setJoints(float shoulderAngleRads, float elbowAngle)
+  {
+    setShoulder(shoulderAngleRads);
+    setElbow(elbowAngle);
+    _shoulder.commit();
+    _elbow.commit();
   }
 
   /**
@@ -0,0 +1,357 @@
+//------------------------------------------------------------------------------
+// RxBuffer class - a receive ring buffer which sits between the serial port
+// and the parser. On the ATmega it is filled from the executor's timer
+// interrupt, so input keeps arriving while the parser holds a line waiting
+// for room in the motion queue. grbl senders stream by counting the
+// characters they have sent but not seen acknowledged, which only works if
+// the buffer they count against is really there.
+//
+// Each buffer drains one serial port. A board driving several arms gives
+// each its own port and buffer, and every buffer is filled by the same
+// interrupt.
+//
+// While the input is binary frames any byte value may be data, so realtime
+// commands come as FRAME_REALTIME frames instead. The bytes which could
+// start one are kept back until it is complete, and a whole realtime frame
+// is taken out of the input like a realtime byte is from text.
+//------------------------------------------------------------------------------
+// Copyright at end of file.
+
+#ifndef SerialRx_H
+#define SerialRx_H
+
+#include "BinaryProtocol.h"
+
+// Size of the receive ring. One slot stays free to tell full from empty, so
+// senders may have RX_BUFFER_SIZE - 1 characters in flight. 128 matches the
+// grbl default which character counting senders assume for v0.8. The
+// indices are bytes, so it may be at most 256.
+#ifndef RX_BUFFER_SIZE
+#define RX_BUFFER_SIZE 128
+#endif
+
+// Realtime commands. They are taken out of the input as they arrive rather
+// than waiting their turn behind queued lines. The bytes follow grbl 1.1.
+#define CMD_STATUS_REPORT '?'
+#define CMD_FEED_HOLD '!'
+#define CMD_CYCLE_START '~'
+#define CMD_RESET 0x18                  // Ctrl-X
+#define CMD_FEED_OVR_RESET 0x90         // back to 100%
+#define CMD_FEED_OVR_COARSE_PLUS 0x91   // +10%
+#define CMD_FEED_OVR_COARSE_MINUS 0x92  // -10%
+#define CMD_FEED_OVR_FINE_PLUS 0x93     // +1%
+#define CMD_FEED_OVR_FINE_MINUS 0x94    // -1%
+
+// Bits of the realtime commands waiting to be acted upon. A command sent
+// again before it is acted upon counts once.
+#define RT_STATUS_REPORT 0x0001
+#define RT_FEED_HOLD 0x0002
+#define RT_CYCLE_START 0x0004
+#define RT_RESET 0x0008
+#define RT_FEED_OVR_RESET 0x0010
+#define RT_FEED_OVR_COARSE_PLUS 0x0020
+#define RT_FEED_OVR_COARSE_MINUS 0x0040
+#define RT_FEED_OVR_FINE_PLUS 0x0080
+#define RT_FEED_OVR_FINE_MINUS 0x0100
+
+class RxBuffer;
+
+// Every receive buffer, linked through their _next members, so they can all
+// be filled from one interrupt.
+static RxBuffer *rxBuffers = NULL;
+
+class RxBuffer
+{
+public:
+  /**
+   * Constructor used to bind the buffer to its serial port.
+   * @param port - the port whose input is buffered, and which the parser
+   *   reading the buffer answers on.
+   */
+  RxBuffer(HardwareSerial *port)
+  {
+    _port = port;
+    _head = 0;
+    _tail = 0;
+    _binary = false;
+    _escaped = 0;
+    _commands = 0;
+    _next = rxBuffers;
+    rxBuffers = this;
+  }
+
+  HardwareSerial *port()
+  {
+    return _port;
+  }
+
+  RxBuffer *next()
+  {
+    return _next;
+  }
+
+  /**
+   * Moves waiting bytes from the serial port into the ring. When the ring is
+   * full they are left in the port's own buffer rather than dropped, though
+   * a realtime command at their front is still taken.
+   */
+  void fill()
+  {
+    while (_port->available() > 0)
+    {
+      if (_binary)
+      {
+        if (!takeFrameByte())
+        {
+          return;
+        }
+        continue;
+      }
+
+      unsigned int command = realtimeCommand(_port->peek());
+      if (command != 0)
+      {
+        _port->read();
+        _commands |= command;
+        continue;
+      }
+
+      if ((_head + 1) % RX_BUFFER_SIZE == _tail)
+      {
+        return;
+      }
+      store(_port->read());
+    }
+  }
+
+  /**
+   * Switches between taking realtime commands as bytes of text and as
+   * realtime frames. Bytes kept back as the start of a realtime frame are
+   * passed on when the input returns to text.
+   */
+  void setBinary(boolean binary)
+  {
+    noInterrupts();
+    for (byte i = 0; i < _escaped; i++)
+    {
+      store(_escape[i]);
+    }
+    _escaped = 0;
+    _binary = binary;
+    interrupts();
+  }
+
+  /**
+   * Returns the RT_ bits of the realtime commands received since the last
+   * call, each of which is to be acted upon once.
+   */
+  unsigned int takeRealtime()
+  {
+    noInterrupts();
+    unsigned int commands = _commands;
+    _commands = 0;
+    interrupts();
+    return commands;
+  }
+
+  /**
+   * Discards the bytes waiting to be read, for a reset.
+   */
+  void clear()
+  {
+    noInterrupts();
+    _tail = _head;
+    _escaped = 0;
+    interrupts();
+  }
+
+  /**
+   * Returns the number of bytes waiting to be read.
+   */
+  int available()
+  {
+    return (RX_BUFFER_SIZE + _head - _tail) % RX_BUFFER_SIZE;
+  }
+
+  /**
+   * Returns the next byte, or -1 if the ring is empty.
+   */
+  int read()
+  {
+    if (_head == _tail)
+    {
+      return -1;
+    }
+    byte c = _buffer[_tail];
+    _tail = (_tail + 1) % RX_BUFFER_SIZE;
+    return c;
+  }
+
+  /**
+   * Number of characters a sender may have outstanding.
+   */
+  int capacity()
+  {
+    return RX_BUFFER_SIZE - 1;
+  }
+
+private:
+  HardwareSerial *_port;
+  RxBuffer *_next;
+
+  // The interrupt only moves the head and the parser only moves the tail.
+  volatile byte _head;
+  volatile byte _tail;
+  byte _buffer[RX_BUFFER_SIZE];
+
+  boolean _binary;
+  volatile unsigned int _commands;
+
+  // Binary input which may be the start of a realtime frame.
+  byte _escape[FRAME_OVERHEAD + 1];
+  byte _escaped;
+
+  void store(byte c)
+  {
+    _buffer[_head] = c;
+    _head = (_head + 1) % RX_BUFFER_SIZE;
+  }
+
+  /**
+   * Takes a byte of binary input. It is kept back while it and those before
+   * it may be a realtime frame, and the frame is acted upon once complete.
+   * Kept bytes which turn out to be ordinary frame bytes go into the ring.
+   * @return false if the ring may not have room for them.
+   */
+  boolean takeFrameByte()
+  {
+    if (RX_BUFFER_SIZE - 1 - available() <= _escaped)
+    {
+      return false;
+    }
+    _escape[_escaped++] = _port->read();
+    while (_escaped > 0 && !isRealtimeFrameStart())
+    {
+      store(_escape[0]);
+      _escaped--;
+      for (byte i = 0; i < _escaped; i++)
+      {
+        _escape[i] = _escape[i + 1];
+      }
+    }
+    if (_escaped == FRAME_OVERHEAD + 1)
+    {
+      _commands |= realtimeCommand(_escape[3]);
+      _escaped = 0;
+    }
+    return true;
+  }
+
+  /**
+   * Returns true if the kept bytes are the start of a realtime frame, or
+   * all of one: its sync, type, sequence 0, command and CRC.
+   */
+  boolean isRealtimeFrameStart()
+  {
+    byte crc = 0;
+    for (byte i = 0; i < _escaped; i++)
+    {
+      byte c = _escape[i];
+      switch (i)
+      {
+      case 0:
+        if (c != FRAME_SYNC)
+        {
+          return false;
+        }
+        continue;
+      case 1:
+        if (c != FRAME_REALTIME)
+        {
+          return false;
+        }
+        break;
+      case 2:
+        if (c != 0)
+        {
+          return false;
+        }
+        break;
+      case 3:
+        if (realtimeCommand(c) == 0)
+        {
+          return false;
+        }
+        break;
+      default:
+        return c == crc;
+      }
+      crc = crc8Update(crc, c);
+    }
+    return true;
+  }
+
+  /**
+   * Returns the RT_ bit of a realtime command byte, or 0 for other bytes.
+   */
+  static unsigned int realtimeCommand(int c)
+  {
+    switch (c)
+    {
+    case CMD_STATUS_REPORT:
+      return RT_STATUS_REPORT;
+    case CMD_FEED_HOLD:
+      return RT_FEED_HOLD;
+    case CMD_CYCLE_START:
+      return RT_CYCLE_START;
+    case CMD_RESET:
+      return RT_RESET;
+    case CMD_FEED_OVR_RESET:
+      return RT_FEED_OVR_RESET;
+    case CMD_FEED_OVR_COARSE_PLUS:
+      return RT_FEED_OVR_COARSE_PLUS;
+    case CMD_FEED_OVR_COARSE_MINUS:
+      return RT_FEED_OVR_COARSE_MINUS;
+    case CMD_FEED_OVR_FINE_PLUS:
+      return RT_FEED_OVR_FINE_PLUS;
+    case CMD_FEED_OVR_FINE_MINUS:
+      return RT_FEED_OVR_FINE_MINUS;
+    default:
+      return 0;
+    }
+  }
+};
+
+static RxBuffer serialRx(&Serial);
+
+/**
+ * Fills every receive buffer from its port.
+ */
+inline void fillRxBuffers()
+{
+  for (RxBuffer *rx = rxBuffers; rx != NULL; rx = rx->next())
+  {
+    rx->fill();
+  }
+}
+
+#endif  // SerialRx_H
+
+/*
+┌──────────────────────────────────────────────────────────────────────────┐
+│                                                   TERMS OF USE: MIT License                                                   │
+├──────────────────────────────────────────────────────────────────────────┤
+│Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation     │
+│files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,     │
+│modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software │
+│is furnished to do so, subject to the following conditions:                                                                    │
+│                                                                                                                               │
+│The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. │
+│                                                                                                                               │
+│THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE           │
+│WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR          │
+│COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,    │
+│ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                          │
+└──────────────────────────────────────────────────────────────────────────┘
+*/
+
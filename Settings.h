@@ -0,0 +1,233 @@
+//------------------------------------------------------------------------------
+// Settings class - machine settings kept in EEPROM and changed over the
+// serial port in the style of grbl, so recalibrating does not need a reflash.
+// "$$" lists them and "$n=value" changes one, which takes effect at once and
+// is stored. The layout is a version byte, the values as floats, and a CRC-8
+// over both. Settings stored by another layout version, or whose CRC fails,
+// are replaced by the sketch's defaults.
+//
+// The bone lengths are not settings, as they are template parameters of the
+// arm so the compiler can fold them into the kinematics.
+//------------------------------------------------------------------------------
+// Copyright at end of file.
+
+#ifndef Settings_H
+#define Settings_H
+
+#include <EEPROM.h>
+#include "BinaryProtocol.h"
+
+// Bump when the settings change meaning or order.
+#define SETTINGS_VERSION 2
+
+// EEPROM address of the version byte.
+#define SETTINGS_ADDRESS 0
+
+// Setting numbers, as used in $n=value.
+#define SETTING_JOINT1_CENTER 0       // us
+#define SETTING_JOINT1_SCALE 1        // us per radian, negative if inverted
+#define SETTING_JOINT2_CENTER 2       // us
+#define SETTING_JOINT2_SCALE 3        // us per radian, negative if inverted
+#define SETTING_X_OFFSET 4            // mm
+#define SETTING_Y_OFFSET 5            // mm
+#define SETTING_FEEDRATE 6            // mm/min
+#define SETTING_ACCELERATION 7        // mm/s^2
+#define SETTING_JUNCTION_DEVIATION 8  // mm
+#define SETTING_JOINT_VELOCITY 9      // radians/s, 0 for no limit
+#define SETTING_JOINT_ACCELERATION 10 // radians/s^2, 0 for no limit
+#define SETTING_PEN_CENTER 11         // us with the pen at the paper
+#define SETTING_PEN_SCALE 12          // us per mm, negative if inverted
+#define SETTING_PEN_UP 13             // mm
+#define SETTING_PEN_DOWN 14           // mm, negative presses on the paper
+#define SETTING_PEN_SECONDS 15        // s from up to down
+#define SETTINGS_COUNT 16
+
+class Settings
+{
+public:
+  /**
+   * Loads the stored settings, falling back to the defaults. Called once at
+   * boot, after which the sketch applies them.
+   * @param defaults - SETTINGS_COUNT values in PROGMEM, in setting order.
+   * @param apply - copies the settings into the machine whenever one
+   *   changes.
+   * @param idle - returns true while every arm the settings apply to has
+   *   stopped with nothing queued, so they may be changed.
+   * @return false if the stored settings were unusable, in which case the
+   *   defaults have been stored in their place.
+   */
+  boolean begin(const float *defaults, void (*apply)(), boolean (*idle)())
+  {
+    _idle = idle;
+    _apply = apply;
+    boolean loaded = load();
+    if (!loaded)
+    {
+      memcpy_P(_values, defaults, sizeof(_values));
+      store();
+    }
+    return loaded;
+  }
+
+  float get(byte n)
+  {
+    return _values[n];
+  }
+
+  /**
+   * Returns true if the settings may be changed now. Arms sharing the board
+   * share the settings, so changing them while any arm moves would upset
+   * its queued moves and calibration.
+   */
+  boolean canChange()
+  {
+    return _idle();
+  }
+
+  /**
+   * Changes a setting, stores it and applies it.
+   * @param n - the setting number, less than SETTINGS_COUNT.
+   * @return false if the value is negative and the setting may not be.
+   */
+  boolean set(byte n, float value)
+  {
+    switch (n)
+    {
+    case SETTING_JOINT1_SCALE:
+    case SETTING_JOINT2_SCALE:
+    case SETTING_X_OFFSET:
+    case SETTING_Y_OFFSET:
+    case SETTING_PEN_SCALE:
+    case SETTING_PEN_DOWN:
+      break;
+    default:
+      if (value < 0)
+      {
+        return false;
+      }
+    }
+    _values[n] = value;
+    store();
+    _apply();
+    return true;
+  }
+
+  /**
+   * Prints each setting as "$n=value (description)".
+   * @param port - the serial port asking for them.
+   */
+  void report(HardwareSerial *port)
+  {
+    for (byte n = 0; n < SETTINGS_COUNT; n++)
+    {
+      port->print(F("$"));
+      port->print(n);
+      port->print(F("="));
+      port->print(_values[n], 3);
+      port->print(F(" ("));
+      switch (n)
+      {
+      case SETTING_JOINT1_CENTER:
+        port->print(F("joint 1 center, usec")); break;
+      case SETTING_JOINT1_SCALE:
+        port->print(F("joint 1 scale, usec/rad")); break;
+      case SETTING_JOINT2_CENTER:
+        port->print(F("joint 2 center, usec")); break;
+      case SETTING_JOINT2_SCALE:
+        port->print(F("joint 2 scale, usec/rad")); break;
+      case SETTING_X_OFFSET:
+        port->print(F("x offset, mm")); break;
+      case SETTING_Y_OFFSET:
+        port->print(F("y offset, mm")); break;
+      case SETTING_FEEDRATE:
+        port->print(F("default feed, mm/min")); break;
+      case SETTING_ACCELERATION:
+        port->print(F("acceleration, mm/sec^2")); break;
+      case SETTING_JUNCTION_DEVIATION:
+        port->print(F("junction deviation, mm")); break;
+      case SETTING_JOINT_VELOCITY:
+        port->print(F("joint max rate, rad/sec")); break;
+      case SETTING_JOINT_ACCELERATION:
+        port->print(F("joint max acceleration, rad/sec^2")); break;
+      case SETTING_PEN_CENTER:
+        port->print(F("pen center, usec")); break;
+      case SETTING_PEN_SCALE:
+        port->print(F("pen scale, usec/mm")); break;
+      case SETTING_PEN_UP:
+        port->print(F("pen up, mm")); break;
+      case SETTING_PEN_DOWN:
+        port->print(F("pen down, mm")); break;
+      case SETTING_PEN_SECONDS:
+        port->print(F("pen up to down, sec")); break;
+      }
+      port->print(F(")\r\n"));
+    }
+  }
+
+private:
+  float _values[SETTINGS_COUNT];
+  void (*_apply)();
+  boolean (*_idle)();
+
+  /**
+   * Reads the stored settings into _values.
+   * @return false if the version or CRC does not match.
+   */
+  boolean load()
+  {
+    byte version = EEPROM.read(SETTINGS_ADDRESS);
+    if (version != SETTINGS_VERSION)
+    {
+      return false;
+    }
+
+    byte crc = crc8Update(0, version);
+    byte *bytes = (byte *)_values;
+    for (unsigned int i = 0; i < sizeof(_values); i++)
+    {
+      bytes[i] = EEPROM.read(SETTINGS_ADDRESS + 1 + i);
+      crc = crc8Update(crc, bytes[i]);
+    }
+    return crc == EEPROM.read(SETTINGS_ADDRESS + 1 + sizeof(_values));
+  }
+
+  /**
+   * Writes _values to EEPROM. Only bytes which differ are written, as each
+   * cell wears out after about 100,000 writes.
+   */
+  void store()
+  {
+    EEPROM.update(SETTINGS_ADDRESS, SETTINGS_VERSION);
+    byte crc = crc8Update(0, SETTINGS_VERSION);
+    const byte *bytes = (const byte *)_values;
+    for (unsigned int i = 0; i < sizeof(_values); i++)
+    {
+      EEPROM.update(SETTINGS_ADDRESS + 1 + i, bytes[i]);
+      crc = crc8Update(crc, bytes[i]);
+    }
+    EEPROM.update(SETTINGS_ADDRESS + 1 + sizeof(_values), crc);
+  }
+};
+
+static Settings settings;
+
+#endif  // Settings_H
+
+/*
+┌──────────────────────────────────────────────────────────────────────────┐
+│                                                   TERMS OF USE: MIT License                                                   │
+├──────────────────────────────────────────────────────────────────────────┤
+│Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation     │
+│files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,     │
+│modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software │
+│is furnished to do so, subject to the following conditions:                                                                    │
+│                                                                                                                               │
+│The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. │
+│                                                                                                                               │
+│THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE           │
+│WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR          │
+│COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,    │
+│ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                          │
+└──────────────────────────────────────────────────────────────────────────┘
+*/
+
@@ -0,0 +1,152 @@
+//------------------------------------------------------------------------------
+// Status report - answers the realtime '?' command in the style of grbl:
+//
+//   <Run,MPos:10.000,120.000,0.000,Buf:7,RX:42,F:3000,Ov:100>
+//
+// giving the machine state, the pen position as executed so far, the blocks
+// in the planner's queue, the bytes waiting in the receive buffer, the
+// tool's current speed in mm/min and the feed override in percent. The state is Idle, Run, or during a feed hold
+// Hold:1 while stopping and Hold:0 once stopped. While a stored job plays
+// with JOB_STORAGE, ",SD:" gives the percent of it read so far. When several
+// arms share the board, each answers on its own port and goes on with
+//
+//   ,Arm:1,Thru:2400,CPU:18
+//
+// which are the arm's number, the mm/min it has drawn since its last report,
+// and the percent of that time the board spent on its parser and executor.
+// With PERF_COUNTERS defined the report goes on with the counters since the last
+// report:
+//
+//   ,IK:850,Loop:1204,Starved:35,Reject:0
+//
+// which are inverse kinematics solutions per second, the longest time in
+// microseconds between passes of loop(), milliseconds the queue ran dry
+// between moves, and positions refused as out of reach.
+//------------------------------------------------------------------------------
+// Copyright at end of file.
+
+#ifndef StatusReport_H
+#define StatusReport_H
+
+#include "Executor.h"
+
+// Work done for one of several arms sharing the board since its last status
+// report, kept by the ArmScheduler.
+class ArmLoad
+{
+public:
+  ArmLoad()
+  {
+    index = 0;
+    busyMicros = 0;
+    since = 0;
+    startDistance = 0;
+  }
+
+  /**
+   * Starts the counts over from the executor's distance so far.
+   */
+  void reset(Executor *executor)
+  {
+    busyMicros = 0;
+    since = micros();
+    startDistance = executor->getDistance();
+  }
+
+  // The arm's number, counting from 0.
+  byte index;
+
+  // Microseconds spent in the arm's parser and executor.
+  unsigned long busyMicros;
+
+  // When the counts started, in micros, and the executor's distance then.
+  unsigned long since;
+  float startDistance;
+};
+
+/**
+ * reportStatus - prints a status report to the serial port of the receive
+ * buffer, with the arm's load if it shares the board with others.
+ */
+void reportStatus(GCodeProcessor *arm, Planner *planner, Executor *executor, RxBuffer *rx,
+                  ArmLoad *load = NULL)
+{
+  HardwareSerial *port = rx->port();
+  if (executor->isHolding())
+  {
+    port->print(executor->isHeld() ? F("<Hold:0") : F("<Hold:1"));
+  }
+  else
+  {
+    port->print(planner->idle() && executor->isIdle() ? F("<Idle") : F("<Run"));
+  }
+  port->print(F(",MPos:"));
+  port->print(arm->getX(), 3);
+  port->print(F(","));
+  port->print(arm->getY(), 3);
+  port->print(F(","));
+  port->print(arm->getZ(), 3);
+  port->print(F(",Buf:"));
+  port->print(planner->queued());
+  port->print(F(",RX:"));
+  port->print(rx->available());
+  port->print(F(",F:"));
+  port->print((long)(executor->getSpeed() * 60 + 0.5));
+  port->print(F(",Ov:"));
+  port->print(executor->getFeedOverride());
+#ifdef JOB_STORAGE
+  if (rx == &serialRx && jobs.isPlaying())
+  {
+    port->print(F(",SD:"));
+    port->print(jobs.progress());
+  }
+#endif
+
+  if (load != NULL)
+  {
+    unsigned long span = micros() - load->since;
+    float millimeters = executor->getDistance() - load->startDistance;
+    port->print(F(",Arm:"));
+    port->print(load->index);
+    port->print(F(",Thru:"));
+    port->print(span > 0 ? (long)(millimeters * 60E6 / span + 0.5) : 0L);
+    port->print(F(",CPU:"));
+    port->print(span > 0 ? (long)(load->busyMicros * 100.0 / span + 0.5) : 0L);
+    load->reset(executor);
+  }
+
+#ifdef PERF_COUNTERS
+  unsigned long elapsed = micros() - perf.since;
+  port->print(F(",IK:"));
+  port->print(elapsed > 0 ? (unsigned long)(perf.solves * 1E6 / elapsed) : 0UL);
+  port->print(F(",Loop:"));
+  port->print(perf.worstLoopMicros);
+  port->print(F(",Starved:"));
+  port->print(perf.starvedTicks * 1000UL / EXECUTOR_TICK_HZ);
+  port->print(F(",Reject:"));
+  port->print(perf.rejections);
+  perf.reset();
+#endif
+  port->print(F(">\r\n"));
+}
+
+#endif  // StatusReport_H
+
+/*
+┌──────────────────────────────────────────────────────────────────────────┐
+│                                                   TERMS OF USE: MIT License                                                   │
+├──────────────────────────────────────────────────────────────────────────┤
+│Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation     │
+│files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,     │
+│modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software │
+│is furnished to do so, subject to the following conditions:                                                                    │
+│                                                                                                                               │
+│The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. │
+│                                                                                                                               │
+│THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE           │
+│WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR          │
+│COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,    │
+│ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                          │
+└──────────────────────────────────────────────────────────────────────────┘
+*/
+
@@ -0,0 +1,280 @@
+//------------------------------------------------------------------------------
+// Virtual clock and serial port of the host stand-in for the Arduino core.
+//------------------------------------------------------------------------------
+// Copyright at end of file.
+
+#include <Arduino.h>
+
+// Virtual time is kept in nanoseconds so timer matches fall between
+// microseconds.
+static unsigned long long simNanos = 0;
+
+// Compare match timer.
+static void (*timerHandler)() = NULL;
+static unsigned long timerTickNanos = 0;
+static unsigned long long timerMatch = 0;
+
+// Pin levels and pulse statistics.
+#define SIM_PINS 20
+static byte pinLevel[SIM_PINS];
+static unsigned long long pinRise[SIM_PINS];
+static unsigned long pinPulses[SIM_PINS];
+static float pinShortest[SIM_PINS];
+static float pinLongest[SIM_PINS];
+static unsigned long long pinFirst[SIM_PINS];
+static unsigned long long pinLast[SIM_PINS];
+
+FILE *simTrace = NULL;
+
+unsigned long micros()
+{
+  return simNanos / 1000;
+}
+
+unsigned long millis()
+{
+  return simNanos / 1000000;
+}
+
+void delay(unsigned long ms)
+{
+  simAdvance(ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+  simAdvance(us);
+}
+
+void simAdvance(unsigned long us)
+{
+  unsigned long long target = simNanos + us * 1000ULL;
+  while (timerHandler != NULL && timerMatch <= target)
+  {
+    simNanos = timerMatch;
+    timerHandler();
+  }
+  simNanos = target;
+}
+
+void simTimerStart(void (*handler)(), unsigned long tickNanos)
+{
+  timerHandler = handler;
+  timerTickNanos = tickNanos;
+  timerMatch = simNanos;
+}
+
+void simTimerSchedule(unsigned int ticks)
+{
+  timerMatch += (unsigned long long)ticks * timerTickNanos;
+}
+
+void pinMode(byte pin, byte mode)
+{
+}
+
+void digitalWrite(byte pin, byte value)
+{
+  if (pin >= SIM_PINS || pinLevel[pin] == value)
+  {
+    return;
+  }
+  pinLevel[pin] = value;
+  if (value == HIGH)
+  {
+    pinRise[pin] = simNanos;
+    return;
+  }
+
+  float width = (simNanos - pinRise[pin]) / 1000.0;
+  if (pinPulses[pin] == 0)
+  {
+    pinFirst[pin] = pinRise[pin];
+    pinShortest[pin] = width;
+    pinLongest[pin] = width;
+  }
+  pinShortest[pin] = min(pinShortest[pin], width);
+  pinLongest[pin] = max(pinLongest[pin], width);
+  pinLast[pin] = pinRise[pin];
+  pinPulses[pin]++;
+
+  if (simTrace != NULL)
+  {
+    fprintf(simTrace, "%.3f,%d,%.3f\n", pinRise[pin] / 1000.0, pin, width);
+  }
+}
+
+void simReportPins(FILE *out)
+{
+  for (int pin = 0; pin < SIM_PINS; pin++)
+  {
+    if (pinPulses[pin] < 2)
+    {
+      continue;
+    }
+    float span = (pinLast[pin] - pinFirst[pin]) / 1E9;
+    fprintf(out, "pin %d: %lu pulses, %.2f per second, %.3f to %.3f us wide\n", pin,
+      pinPulses[pin], (pinPulses[pin] - 1) / span, pinShortest[pin], pinLongest[pin]);
+  }
+}
+
+HardwareSerial Serial;
+HardwareSerial Serial1;
+
+HardwareSerial::HardwareSerial()
+{
+  overruns = 0;
+  _byteMicros = 0;
+  _nextArrival = 0;
+}
+
+void HardwareSerial::begin(unsigned long baud)
+{
+  // A start bit, eight data bits and a stop bit per byte.
+  _byteMicros = 10000000UL / baud;
+}
+
+int HardwareSerial::available()
+{
+  receive();
+  return _rx.size();
+}
+
+int HardwareSerial::read()
+{
+  receive();
+  if (_rx.empty())
+  {
+    return -1;
+  }
+  char c = _rx.front();
+  _rx.pop_front();
+  return (unsigned char)c;
+}
+
+int HardwareSerial::peek()
+{
+  receive();
+  if (_rx.empty())
+  {
+    return -1;
+  }
+  return (unsigned char)_rx.front();
+}
+
+void HardwareSerial::print(const char *s)
+{
+  for (; *s != 0; s++)
+  {
+    print(*s);
+  }
+}
+
+void HardwareSerial::print(char c)
+{
+  if (c == '\n')
+  {
+    _lines.push_back(_output);
+    _output.clear();
+  }
+  else if (c != '\r')
+  {
+    _output += c;
+  }
+}
+
+void HardwareSerial::print(int n)
+{
+  print((long)n);
+}
+
+void HardwareSerial::print(unsigned int n)
+{
+  print((unsigned long)n);
+}
+
+void HardwareSerial::print(long n)
+{
+  char text[16];
+  snprintf(text, sizeof(text), "%ld", n);
+  print(text);
+}
+
+void HardwareSerial::print(unsigned long n)
+{
+  char text[16];
+  snprintf(text, sizeof(text), "%lu", n);
+  print(text);
+}
+
+void HardwareSerial::print(double n, int digits)
+{
+  char text[32];
+  snprintf(text, sizeof(text), "%.*f", digits, n);
+  print(text);
+}
+
+void HardwareSerial::send(const std::string &data)
+{
+  _nextArrival = max(_nextArrival, micros());
+  for (size_t i = 0; i < data.size(); i++)
+  {
+    _nextArrival += _byteMicros;
+    _transit.push_back(std::make_pair(_nextArrival, data[i]));
+  }
+}
+
+boolean HardwareSerial::inTransit()
+{
+  receive();
+  return !_transit.empty();
+}
+
+boolean HardwareSerial::takeLine(std::string *line)
+{
+  if (_lines.empty())
+  {
+    return false;
+  }
+  *line = _lines.front();
+  _lines.pop_front();
+  return true;
+}
+
+/**
+ * Moves bytes whose arrival time has passed into the receive buffer.
+ */
+void HardwareSerial::receive()
+{
+  while (!_transit.empty() && _transit.front().first <= micros())
+  {
+    if (_rx.size() < SERIAL_RX_BUFFER_SIZE - 1)
+    {
+      _rx.push_back(_transit.front().second);
+    }
+    else
+    {
+      overruns++;
+    }
+    _transit.pop_front();
+  }
+}
+
+/*
+┌──────────────────────────────────────────────────────────────────────────┐
+│                                                   TERMS OF USE: MIT License                                                   │
+├──────────────────────────────────────────────────────────────────────────┤
+│Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation     │
+│files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,     │
+│modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software │
+│is furnished to do so, subject to the following conditions:                                                                    │
+│                                                                                                                               │
+│The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. │
+│                                                                                                                               │
+│THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE           │
+│WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR          │
+│COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,    │
+│ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                          │
+└──────────────────────────────────────────────────────────────────────────┘
+*/
+
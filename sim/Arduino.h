@@ -0,0 +1,185 @@
+//------------------------------------------------------------------------------
+// Stand-in for the Arduino core so the firmware builds on a host. Time comes
+// from a virtual clock which only moves when the simulator advances it, so
+// runs are repeatable and take a fraction of real time. Only the parts of the
+// core which the firmware uses are provided.
+//------------------------------------------------------------------------------
+// Copyright at end of file.
+
+#ifndef Arduino_H
+#define Arduino_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <deque>
+#include <string>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define PI 3.1415926535897932384626433832795
+
+// The core defines these as macros too, so mixed argument types work.
+#define min(a,b) ((a)<(b)?(a):(b))
+#define max(a,b) ((a)>(b)?(a):(b))
+#define constrain(x,low,high) ((x)<(low)?(low):((x)>(high)?(high):(x)))
+#define sq(x) ((x)*(x))
+
+// Flash strings and tables are ordinary memory on the host.
+#define F(s) (s)
+#define PROGMEM
+#define pgm_read_byte(a) (*(const uint8_t *)(a))
+#define pgm_read_word(a) (*(const uint16_t *)(a))
+#define pgm_read_dword(a) (*(const uint32_t *)(a))
+#define strcpy_P(d,s) strcpy((d),(s))
+#define memcpy_P(d,s,n) memcpy((d),(s),(n))
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+
+// There are no real interrupts, timer handlers run from simAdvance.
+#define noInterrupts()
+#define interrupts()
+
+// Clock of the ATmega328 the firmware runs on.
+#define F_CPU 16000000L
+#define clockCyclesPerMicrosecond() (F_CPU / 1000000L)
+
+unsigned long micros();
+unsigned long millis();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+/**
+ * simAdvance - moves the virtual clock forward, running the timer handler
+ * at each compare match passed on the way.
+ * @param us - microseconds to advance by.
+ */
+void simAdvance(unsigned long us);
+
+/**
+ * simTimerStart - stands in for a compare match timer in CTC mode.
+ * @param handler - called at each match, like the interrupt.
+ * @param tickNanos - length of a timer tick in nanoseconds.
+ */
+void simTimerStart(void (*handler)(), unsigned long tickNanos);
+
+/**
+ * simTimerSchedule - sets the ticks from the last match to the next one.
+ */
+void simTimerSchedule(unsigned int ticks);
+
+void pinMode(byte pin, byte mode);
+
+/**
+ * digitalWrite - records the pin level. Each high pulse is written to the
+ * trace as its rising edge time, pin and width in microseconds.
+ */
+void digitalWrite(byte pin, byte value);
+
+/**
+ * simReportPins - prints the pulse statistics of each pin which pulsed.
+ */
+void simReportPins(FILE *out);
+
+// Trace written by the Servo stand-in and pulsed pins, or NULL for none.
+extern FILE *simTrace;
+
+// Size of the receive buffer in the core's HardwareSerial.
+#define SERIAL_RX_BUFFER_SIZE 64
+
+// Serial port whose far end is the simulator. Bytes sent to the firmware
+// arrive at the configured baud rate of virtual time, and are dropped like
+// on the real port if its receive buffer is full. Output is split into lines
+// which the simulator collects.
+class HardwareSerial
+{
+public:
+  HardwareSerial();
+
+  void begin(unsigned long baud);
+  int available();
+  int read();
+  int peek();
+
+  void print(const char *s);
+  void print(char c);
+  void print(int n);
+  void print(unsigned int n);
+  void print(long n);
+  void print(unsigned long n);
+  void print(double n, int digits = 2);
+
+  template<class T> void println(T value)
+  {
+    print(value);
+    println();
+  }
+
+  void println()
+  {
+    print("\r\n");
+  }
+
+  // Simulator side of the port.
+
+  /**
+   * send - queues bytes to arrive after any already in transit.
+   */
+  void send(const std::string &data);
+
+  /**
+   * inTransit - returns true while sent bytes have not reached the port.
+   */
+  boolean inTransit();
+
+  /**
+   * takeLine - removes the oldest complete output line, without its end.
+   * @return false if there is no complete line.
+   */
+  boolean takeLine(std::string *line);
+
+  // Number of bytes lost to a full receive buffer.
+  unsigned long overruns;
+
+private:
+  unsigned long _byteMicros;
+  unsigned long _nextArrival;
+  std::deque<std::pair<unsigned long, char> > _transit;
+  std::deque<char> _rx;
+  std::string _output;
+  std::deque<std::string> _lines;
+
+  void receive();
+};
+
+extern HardwareSerial Serial;
+
+// A second port, as on the Mega.
+extern HardwareSerial Serial1;
+
+#endif  // Arduino_H
+
+/*
+┌──────────────────────────────────────────────────────────────────────────┐
+│                                                   TERMS OF USE: MIT License                                                   │
+├──────────────────────────────────────────────────────────────────────────┤
+│Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation     │
+│files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,     │
+│modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software │
+│is furnished to do so, subject to the following conditions:                                                                    │
+│                                                                                                                               │
+│The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. │
+│                                                                                                                               │
+│THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE           │
+│WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR          │
+│COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,    │
+│ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                          │
+└──────────────────────────────────────────────────────────────────────────┘
+*/
+
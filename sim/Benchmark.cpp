@@ -0,0 +1,45 @@
+//------------------------------------------------------------------------------
+// Host build of the benchmarks in Benchmark.h. The JSON line they print is
+// written to stdout, timed in nanoseconds of host time.
+//
+// Usage:
+//   drawbot_bench > results.json
+//------------------------------------------------------------------------------
+// Copyright at end of file.
+
+#define BENCHMARK
+#include "../DrawbotMkII.ino"
+
+int main(int argc, char **argv)
+{
+  setup();
+
+  std::string line;
+  while (Serial.takeLine(&line))
+  {
+    if (line.compare(0, 1, "{") == 0)
+    {
+      printf("%s\n", line.c_str());
+    }
+  }
+  return 0;
+}
+
+/*
+┌──────────────────────────────────────────────────────────────────────────┐
+│                                                   TERMS OF USE: MIT License                                                   │
+├──────────────────────────────────────────────────────────────────────────┤
+│Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation     │
+│files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,     │
+│modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software │
+│is furnished to do so, subject to the following conditions:                                                                    │
+│                                                                                                                               │
+│The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. │
+│                                                                                                                               │
+│THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE           │
+│WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR          │
+│COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,    │
+│ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                          │
+└──────────────────────────────────────────────────────────────────────────┘
+*/
+
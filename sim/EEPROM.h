@@ -0,0 +1,75 @@
+//------------------------------------------------------------------------------
+// Stand-in for the EEPROM library, holding the ATmega328's 1 KB in memory.
+// It starts erased each run, as on a newly flashed board.
+//------------------------------------------------------------------------------
+// Copyright at end of file.
+
+#ifndef EEPROM_H
+#define EEPROM_H
+
+#include <Arduino.h>
+#include <string.h>
+
+#define SIM_EEPROM_SIZE 1024
+
+class EEPROMClass
+{
+public:
+  EEPROMClass()
+  {
+    memset(_cells, 0xFF, sizeof(_cells));
+    writes = 0;
+  }
+
+  uint8_t read(int address)
+  {
+    return _cells[address];
+  }
+
+  /**
+   * update - writes a byte only if it differs, which saves the real part's
+   * limited write cycles.
+   */
+  void update(int address, uint8_t value)
+  {
+    if (_cells[address] != value)
+    {
+      _cells[address] = value;
+      writes++;
+    }
+  }
+
+  uint16_t length()
+  {
+    return SIM_EEPROM_SIZE;
+  }
+
+  // Bytes changed, to check settings are only written when they change.
+  unsigned long writes;
+
+private:
+  uint8_t _cells[SIM_EEPROM_SIZE];
+};
+
+static EEPROMClass EEPROM;
+
+#endif  // EEPROM_H
+
+/*
+┌──────────────────────────────────────────────────────────────────────────┐
+│                                                   TERMS OF USE: MIT License                                                   │
+├──────────────────────────────────────────────────────────────────────────┤
+│Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation     │
+│files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,     │
+│modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software │
+│is furnished to do so, subject to the following conditions:                                                                    │
+│                                                                                                                               │
+│The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. │
+│                                                                                                                               │
+│THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE           │
+│WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR          │
+│COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,    │
+│ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                          │
+└──────────────────────────────────────────────────────────────────────────┘
+*/
+
@@ -0,0 +1,163 @@
+//------------------------------------------------------------------------------
+// Stand-in for the SD library, keeping the card's files as plain files in a
+// directory of the host, the current one unless setRoot gives another.
+//------------------------------------------------------------------------------
+// Copyright at end of file.
+
+#ifndef SD_H
+#define SD_H
+
+#include <stdio.h>
+#include <string.h>
+#include <Arduino.h>
+
+#define FILE_READ 0x01
+#define FILE_WRITE 0x13
+
+// A handle to an open file. Copies share the file, as with the library.
+class File
+{
+public:
+  File(FILE *file = NULL)
+  {
+    _file = file;
+  }
+
+  int read(void *buffer, uint16_t length)
+  {
+    return _file != NULL ? (int)fread(buffer, 1, length, _file) : -1;
+  }
+
+  int read()
+  {
+    return _file != NULL ? fgetc(_file) : -1;
+  }
+
+  size_t write(const uint8_t *data, size_t length)
+  {
+    return _file != NULL ? fwrite(data, 1, length, _file) : 0;
+  }
+
+  size_t write(uint8_t data)
+  {
+    return write(&data, 1);
+  }
+
+  uint32_t position()
+  {
+    return _file != NULL ? (uint32_t)ftell(_file) : 0;
+  }
+
+  uint32_t size()
+  {
+    if (_file == NULL)
+    {
+      return 0;
+    }
+    long here = ftell(_file);
+    fseek(_file, 0, SEEK_END);
+    long end = ftell(_file);
+    fseek(_file, here, SEEK_SET);
+    return (uint32_t)end;
+  }
+
+  int available()
+  {
+    return (int)min(size() - position(), 0x7FFFUL);
+  }
+
+  void close()
+  {
+    if (_file != NULL)
+    {
+      fclose(_file);
+      _file = NULL;
+    }
+  }
+
+  operator bool()
+  {
+    return _file != NULL;
+  }
+
+private:
+  FILE *_file;
+};
+
+class SDClass
+{
+public:
+  SDClass()
+  {
+    setRoot(".");
+  }
+
+  /**
+   * setRoot - sets the host directory holding the card's files. Not part
+   * of the library.
+   */
+  void setRoot(const char *directory)
+  {
+    snprintf(_root, sizeof(_root), "%s", directory);
+  }
+
+  // The card is always present.
+  boolean begin(uint8_t csPin)
+  {
+    return true;
+  }
+
+  File open(const char *path, uint8_t mode = FILE_READ)
+  {
+    return File(fopen(hostPath(path), mode == FILE_READ ? "rb" : "ab+"));
+  }
+
+  boolean exists(const char *path)
+  {
+    FILE *file = fopen(hostPath(path), "rb");
+    if (file == NULL)
+    {
+      return false;
+    }
+    fclose(file);
+    return true;
+  }
+
+  boolean remove(const char *path)
+  {
+    return ::remove(hostPath(path)) == 0;
+  }
+
+private:
+  char _root[256];
+  char _path[512];
+
+  const char *hostPath(const char *path)
+  {
+    snprintf(_path, sizeof(_path), "%s/%s", _root, path);
+    return _path;
+  }
+};
+
+static SDClass SD;
+
+#endif  // SD_H
+
+/*
+┌──────────────────────────────────────────────────────────────────────────┐
+│                                                   TERMS OF USE: MIT License                                                   │
+├──────────────────────────────────────────────────────────────────────────┤
+│Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation     │
+│files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,     │
+│modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software │
+│is furnished to do so, subject to the following conditions:                                                                    │
+│                                                                                                                               │
+│The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. │
+│                                                                                                                               │
+│THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE           │
+│WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR          │
+│COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,    │
+│ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                          │
+└──────────────────────────────────────────────────────────────────────────┘
+*/
+
@@ -0,0 +1,110 @@
+//------------------------------------------------------------------------------
+// Host stand-in for the Servo library.
+//------------------------------------------------------------------------------
+// Copyright at end of file.
+
+#include <Servo.h>
+
+Servo::Servo()
+{
+  writes = 0;
+  firstWrite = 0;
+  lastWrite = 0;
+  shortestInterval = 0;
+  _pin = -1;
+  _min = MIN_PULSE_WIDTH;
+  _max = MAX_PULSE_WIDTH;
+  _pulse = 1500;
+}
+
+byte Servo::attach(int pin)
+{
+  return attach(pin, MIN_PULSE_WIDTH, MAX_PULSE_WIDTH);
+}
+
+byte Servo::attach(int pin, int min, int max)
+{
+  _pin = pin;
+  _min = min;
+  _max = max;
+  return 0;
+}
+
+void Servo::detach()
+{
+  _pin = -1;
+}
+
+boolean Servo::attached()
+{
+  return _pin >= 0;
+}
+
+/**
+ * write - like the library, values below the smallest pulse width are
+ * taken as degrees.
+ */
+void Servo::write(int value)
+{
+  if (value < MIN_PULSE_WIDTH)
+  {
+    value = constrain(value, 0, 180);
+    value = _min + (long)value * (_max - _min) / 180;
+  }
+  writeMicroseconds(value);
+}
+
+/**
+ * writeMicroseconds - records the pulse width, clamped to the attached range
+ * as the library does.
+ */
+void Servo::writeMicroseconds(int value)
+{
+  _pulse = constrain(value, _min, _max);
+
+  unsigned long now = micros();
+  if (writes == 0)
+  {
+    firstWrite = now;
+  }
+  else if (writes == 1 || now - lastWrite < shortestInterval)
+  {
+    shortestInterval = now - lastWrite;
+  }
+  lastWrite = now;
+  writes++;
+
+  if (simTrace != NULL)
+  {
+    fprintf(simTrace, "%lu,%d,%d\n", now, _pin, _pulse);
+  }
+}
+
+int Servo::read()
+{
+  return (long)(_pulse - _min) * 180 / (_max - _min);
+}
+
+int Servo::readMicroseconds()
+{
+  return _pulse;
+}
+
+/*
+┌──────────────────────────────────────────────────────────────────────────┐
+│                                                   TERMS OF USE: MIT License                                                   │
+├──────────────────────────────────────────────────────────────────────────┤
+│Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation     │
+│files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,     │
+│modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software │
+│is furnished to do so, subject to the following conditions:                                                                    │
+│                                                                                                                               │
+│The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. │
+│                                                                                                                               │
+│THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE           │
+│WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR          │
+│COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,    │
+│ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                          │
+└──────────────────────────────────────────────────────────────────────────┘
+*/
+
@@ -0,0 +1,68 @@
+//------------------------------------------------------------------------------
+// Stand-in for the Servo library. Each pulse width change is stamped with the
+// virtual clock and written to simTrace, and per servo statistics are kept
+// for the simulator's summary.
+//------------------------------------------------------------------------------
+// Copyright at end of file.
+
+#ifndef Servo_H
+#define Servo_H
+
+#include <Arduino.h>
+
+#define MIN_PULSE_WIDTH 544
+#define MAX_PULSE_WIDTH 2400
+
+class Servo
+{
+public:
+  Servo();
+
+  byte attach(int pin);
+  byte attach(int pin, int min, int max);
+  void detach();
+  boolean attached();
+
+  void write(int value);
+  void writeMicroseconds(int value);
+  int read();
+  int readMicroseconds();
+
+  // Statistics since the servo was attached.
+  unsigned long writes;
+  unsigned long firstWrite;
+  unsigned long lastWrite;
+  unsigned long shortestInterval;
+
+  int pin()
+  {
+    return _pin;
+  }
+
+private:
+  int _pin;
+  int _min;
+  int _max;
+  int _pulse;
+};
+
+#endif  // Servo_H
+
+/*
+┌──────────────────────────────────────────────────────────────────────────┐
+│                                                   TERMS OF USE: MIT License                                                   │
+├──────────────────────────────────────────────────────────────────────────┤
+│Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation     │
+│files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,     │
+│modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software │
+│is furnished to do so, subject to the following conditions:                                                                    │
+│                                                                                                                               │
+│The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. │
+│                                                                                                                               │
+│THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE           │
+│WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR          │
+│COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,    │
+│ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                          │
+└──────────────────────────────────────────────────────────────────────────┘
+*/
+
@@ -0,0 +1,710 @@
+//------------------------------------------------------------------------------
+// Simulator - runs the firmware on a host against the stand-in core. It acts
+// as a grbl character counting sender replaying a G-code file over the
+// virtual serial port, then reports how long the job took and how often
+// each joint's servo was updated.
+//
+// Usage:
+//   drawbot_sim [-b | -j] job.gcode [trace.csv]
+//
+// With -b the job is sent in the binary protocol instead, after converting
+// it to frames on the host with the firmware's Parser. With -j, when built
+// with JOB_STORAGE, the job is uploaded to the card and then run from it,
+// the card being a temporary directory. When built with SECOND_ARM the job
+// is also streamed to the second arm on Serial1, and each arm's status
+// report is given at the end.
+//
+// The summary also compares the speed the pen tip really moved at with the
+// speed planned for it, over each stretch where the planned speed held. It
+// counts the pen's transitions, and any steps taken while the pen was coming
+// off or onto the paper, by the arm's model of its pen servo.
+//
+// The trace has a "micros,pin,pulse" line for every writeMicroseconds call,
+// or with PULSE_ENGINE defined for every pulse generated on a pin.
+// Responses from the firmware are echoed to stdout, the summary goes to
+// stderr.
+//------------------------------------------------------------------------------
+// Copyright at end of file.
+
+#include <unistd.h>
+
+#include "../DrawbotMkII.ino"
+
+// Virtual time which passes per call to loop().
+#ifndef SIM_LOOP_MICROS
+#define SIM_LOOP_MICROS 100
+#endif
+
+// A job which has not finished in this much virtual time is abandoned.
+#define SIM_TIMEOUT_MICROS (3600UL * 1000000UL)
+
+// Shortest stretch of steady planned speed whose real speed is checked.
+#define SIM_SPEED_STRETCH_MICROS 100000UL
+
+// Converts the commands of a job into binary protocol frames, as a sender
+// using the protocol would.
+class FrameEncoder : public GCodeProcessor
+{
+  public:
+    /**
+     * @param frames - receives each frame as one item to send.
+     */
+    FrameEncoder(std::deque<std::string> *frames)
+    {
+      _frames = frames;
+      _sequence = 0;
+      _feed = 0;
+
+      // The firmware parked the arm when it started.
+      _parkX = toUnits(robotArm.getX());
+      _parkY = toUnits(robotArm.getY());
+      _x = _parkX;
+      _y = _parkY;
+      _z = 0;
+    }
+
+    void park()
+    {
+      add(FRAME_HOME, NULL);
+      _x = _parkX;
+      _y = _parkY;
+    }
+
+    float getX() { return _x * (1.0 / FRAME_UNITS_PER_MM); }
+    float getY() { return _y * (1.0 / FRAME_UNITS_PER_MM); }
+    float getZ() { return _z * (1.0 / FRAME_UNITS_PER_MM); }
+    float getA() { return 0; }
+    float getB() { return 0; }
+    float getC() { return 0; }
+
+    void setFeedrate(float f)
+    {
+      uint16_t feed = lround(f);
+      if (feed != _feed)
+      {
+        _feed = feed;
+        byte payload[2] = { (byte)feed, (byte)(feed >> 8) };
+        add(FRAME_FEED, payload);
+      }
+    }
+
+    void setHome(float x, float y, float z, float a, float b, float c)
+    {
+      fprintf(stderr, "M206 has no frame, skipped.\n");
+    }
+
+    void setPosition(float x, float y, float z, float a, float b, float c)
+    {
+      move(x, y, z, FRAME_RAPID, FRAME_RAPID_Z);
+    }
+
+    void movePosition(float x, float y, float z, float a, float b, float c)
+    {
+      long dx = toUnits(x) - _x;
+      long dy = toUnits(y) - _y;
+      if (toUnits(z) == _z && dx >= -128 && dx <= 127 && dy >= -128 && dy <= 127)
+      {
+        byte payload[2] = { (byte)dx, (byte)dy };
+        add(FRAME_STEP, payload);
+        _x += dx;
+        _y += dy;
+        return;
+      }
+      move(x, y, z, FRAME_LINEAR, FRAME_LINEAR_Z);
+    }
+
+    void enableVacuum(boolean enable)
+    {
+      byte payload[1] = { enable ? (byte)1 : (byte)0 };
+      add(FRAME_VACUUM, payload);
+    }
+
+    void dwell(float seconds)
+    {
+      uint16_t ms = lround(seconds * 1000);
+      byte payload[2] = { (byte)ms, (byte)(ms >> 8) };
+      add(FRAME_DWELL, payload);
+    }
+
+    /**
+     * add - encodes a frame with the next sequence number.
+     */
+    void add(byte type, const byte *payload)
+    {
+      byte frame[FRAME_MAX_PAYLOAD + FRAME_OVERHEAD];
+      byte length = writeFrame(type, _sequence++, payload, frame);
+      _frames->push_back(std::string((const char *)frame, length));
+    }
+
+  private:
+    std::deque<std::string> *_frames;
+    byte _sequence;
+    uint16_t _feed;
+
+    // Position in frame units.
+    long _x;
+    long _y;
+    long _z;
+    long _parkX;
+    long _parkY;
+
+    long toUnits(float mm)
+    {
+      return lround(mm * FRAME_UNITS_PER_MM);
+    }
+
+    void move(float x, float y, float z, byte type, byte typeZ)
+    {
+      _x = toUnits(x);
+      _y = toUnits(y);
+      byte payload[6] = { (byte)_x, (byte)(_x >> 8), (byte)_y, (byte)(_y >> 8) };
+      if (toUnits(z) != _z)
+      {
+        _z = toUnits(z);
+        payload[4] = (byte)_z;
+        payload[5] = (byte)(_z >> 8);
+        type = typeZ;
+      }
+      add(type, payload);
+    }
+};
+
+// Measures the pen tip's speed over stretches where the planned speed holds
+// steady. The tip moves in steps, so each stretch is measured between the
+// moments it stepped and the step size does not blur the result.
+class SpeedCheck
+{
+  public:
+    SpeedCheck()
+    {
+      stretches = 0;
+      slowest = 1;
+      fastest = 1;
+      _speed = 0;
+      _stepped = false;
+    }
+
+    /**
+     * Called after each pass of loop() with the planned speed in mm/s.
+     */
+    void sample(float speed, float x, float y)
+    {
+      if (speed <= 0 || fabs(speed - _speed) > _speed * 1E-4)
+      {
+        finish();
+        _speed = speed;
+        _stepped = false;
+      }
+      else if (x != _x || y != _y)
+      {
+        if (!_stepped)
+        {
+          _stepped = true;
+          _first = micros();
+          _distance = 0;
+        }
+        else
+        {
+          _distance += hypot(x - _x, y - _y);
+        }
+        _last = micros();
+      }
+      _x = x;
+      _y = y;
+    }
+
+    /**
+     * Ends the stretch in progress, adding it to the results if it is long
+     * enough to measure.
+     */
+    void finish()
+    {
+      if (_stepped && _last - _first >= SIM_SPEED_STRETCH_MICROS)
+      {
+        float ratio = _distance / ((_last - _first) / 1E6) / _speed;
+        slowest = stretches > 0 ? fmin(slowest, ratio) : ratio;
+        fastest = stretches > 0 ? fmax(fastest, ratio) : ratio;
+        stretches++;
+      }
+      _stepped = false;
+    }
+
+    // Stretches measured and the range of real over planned speed.
+    int stretches;
+    float slowest;
+    float fastest;
+
+  private:
+    float _speed;
+    float _x;
+    float _y;
+    bool _stepped;
+    unsigned long _first;
+    unsigned long _last;
+    float _distance;
+};
+
+// Streams lines to one arm's serial port by character counting: a line is
+// only sent while the lines which have not been answered fit in the receive
+// buffer.
+class Sender
+{
+  public:
+    Sender(HardwareSerial *port, ArmStation *station, GCodeProcessor *arm)
+    {
+      _port = port;
+      _station = station;
+      _arm = arm;
+      _capacity = 0;
+      _buffered = 0;
+      lineNumber = 0;
+      errors = 0;
+      sent = 0;
+      binary = false;
+    }
+
+    /**
+     * Discards the banner and finds the receive buffer size it advertises.
+     * @return false if none was advertised.
+     */
+    bool handshake()
+    {
+      std::string response;
+      while (_port->takeLine(&response))
+      {
+        sscanf(response.c_str(), "[RX:%d]", &_capacity);
+      }
+      return _capacity > 0;
+    }
+
+    /**
+     * Sends as many of the waiting lines as fit.
+     */
+    void send()
+    {
+      // Frames wait for the answer to $B, as until then a '?' in them would
+      // be taken as a realtime command.
+      bool handshaking = binary && lineNumber == 0 && !_outstanding.empty();
+      while (!handshaking && !lines.empty() && _buffered + (int)lines.front().size() <= _capacity)
+      {
+        _buffered += lines.front().size();
+        _outstanding.push_back(lines.front().size());
+        _port->send(lines.front());
+        sent += lines.front().size();
+        lines.pop_front();
+      }
+    }
+
+    /**
+     * Echoes the responses, counting the lines answered and the errors.
+     * @return false if a frame was damaged, which cannot happen here.
+     */
+    bool receive()
+    {
+      std::string response;
+      while (_port->takeLine(&response))
+      {
+        printf("%s\n", response.c_str());
+        if (response.compare(0, 8, "[RESEND:") == 0)
+        {
+          // The link here does not damage frames, so this is a bug.
+          fprintf(stderr, "%s\n", response.c_str());
+          return false;
+        }
+        if (response.compare(0, 10, "[JOB LINE:") == 0)
+        {
+          fprintf(stderr, "%s\n", response.c_str());
+          errors++;
+          continue;
+        }
+        if (response.compare(0, 2, "ok") != 0 && response.compare(0, 5, "error") != 0)
+        {
+          continue;
+        }
+        lineNumber++;
+        if (response[0] == 'e')
+        {
+          fprintf(stderr, "line %d: %s\n", lineNumber, response.c_str());
+          errors++;
+        }
+        if (!_outstanding.empty())
+        {
+          _buffered -= _outstanding.front();
+          _outstanding.pop_front();
+        }
+      }
+      speedCheck.sample(_station->executor.getSpeed(), _arm->getX(), _arm->getY());
+      return true;
+    }
+
+    /**
+     * Returns true once every line has been sent and answered.
+     */
+    bool finished()
+    {
+      return lines.empty() && _outstanding.empty();
+    }
+
+    /**
+     * Asks for a status report and returns it.
+     */
+    std::string status()
+    {
+      _port->send("?");
+      std::string response;
+      while (_port->inTransit() || !_port->takeLine(&response))
+      {
+        loop();
+        simAdvance(SIM_LOOP_MICROS);
+      }
+      return response;
+    }
+
+    std::deque<std::string> lines;
+    int lineNumber;
+    int errors;
+    long sent;
+    bool binary;
+    SpeedCheck speedCheck;
+
+  private:
+    HardwareSerial *_port;
+    ArmStation *_station;
+    GCodeProcessor *_arm;
+    int _capacity;
+    int _buffered;
+    std::deque<int> _outstanding;
+};
+
+// Follows the pen's height by the arm's model of its servo, and counts the
+// steps the arm takes while the pen is on its way between the paper and
+// PEN_CLEARANCE above it, which would drag ink.
+class PenCheck
+{
+  public:
+    PenCheck()
+    {
+      transitions = 0;
+      dragged = 0;
+      _z = robotArm.getZ();
+      _from = _z;
+      _sent = 0;
+      _x = robotArm.getX();
+      _y = robotArm.getY();
+    }
+
+    /**
+     * Called after each pass of loop().
+     */
+    void sample()
+    {
+      if (robotArm.getZ() != _z)
+      {
+        _from = height();
+        _z = robotArm.getZ();
+        _sent = micros();
+        transitions++;
+      }
+      float h = height();
+      if ((robotArm.getX() != _x || robotArm.getY() != _y) && h > 0 && h < PEN_CLEARANCE)
+      {
+        dragged++;
+      }
+      _x = robotArm.getX();
+      _y = robotArm.getY();
+    }
+
+    int transitions;
+    int dragged;
+
+  private:
+    float _z;
+    float _from;
+    unsigned long _sent;
+    float _x;
+    float _y;
+
+    /**
+     * The modelled height of the pen now.
+     */
+    float height()
+    {
+      float from = constrain(_from, robotArm.penHeight(true), robotArm.penHeight(false));
+      float to = constrain(_z, robotArm.penHeight(true), robotArm.penHeight(false));
+      float seconds = robotArm.penSeconds(_from, _z, _z);
+      float moved = (micros() - _sent) / 1E6;
+      return (seconds <= 0 || moved >= seconds) ? to : from + (to - from) * moved / seconds;
+    }
+};
+
+#ifndef PULSE_ENGINE
+/**
+ * reportServo - prints one joint's update statistics.
+ */
+void reportServo(const char *name, Servo &servo)
+{
+  fprintf(stderr, "%s (pin %d): %lu writes", name, servo.pin(), servo.writes);
+  if (servo.writes > 1)
+  {
+    float span = (servo.lastWrite - servo.firstWrite) / 1E6;
+    fprintf(stderr, ", %.1f per second, shortest interval %lu us",
+      (servo.writes - 1) / span, servo.shortestInterval);
+  }
+  fprintf(stderr, "\n");
+}
+#endif
+
+/**
+ * playing - true while a job runs from the card.
+ */
+bool playing()
+{
+#ifdef JOB_STORAGE
+  return jobs.isPlaying();
+#else
+  return false;
+#endif
+}
+
+int main(int argc, char **argv)
+{
+  bool binary = argc > 1 && strcmp(argv[1], "-b") == 0;
+  bool stored = argc > 1 && strcmp(argv[1], "-j") == 0;
+  if (binary || stored)
+  {
+    argc--;
+    argv++;
+  }
+#ifndef JOB_STORAGE
+  if (stored)
+  {
+    fprintf(stderr, "-j needs a build with JOB_STORAGE.\n");
+    return 1;
+  }
+#endif
+  if (argc < 2 || argc > 3)
+  {
+    fprintf(stderr, "usage: %s [-b | -j] job.gcode [trace.csv]\n", argv[0]);
+    return 1;
+  }
+
+  FILE *job = fopen(argv[1], "r");
+  if (job == NULL)
+  {
+    perror(argv[1]);
+    return 1;
+  }
+  std::deque<std::string> lines;
+  char text[256];
+  while (fgets(text, sizeof(text), job) != NULL)
+  {
+    std::string line(text);
+    while (!line.empty() && (line[line.size() - 1] == '\n' || line[line.size() - 1] == '\r'))
+    {
+      line.erase(line.size() - 1);
+    }
+    lines.push_back(line + "\n");
+  }
+  fclose(job);
+
+  if (argc == 3)
+  {
+    simTrace = fopen(argv[2], "w");
+    if (simTrace == NULL)
+    {
+      perror(argv[2]);
+      return 1;
+    }
+    fprintf(simTrace, "micros,pin,pulse\n");
+  }
+
+#ifdef JOB_STORAGE
+  char card[] = "/tmp/drawbot_sd.XXXXXX";
+  if (stored)
+  {
+    if (mkdtemp(card) == NULL)
+    {
+      perror(card);
+      return 1;
+    }
+    SD.setRoot(card);
+  }
+#endif
+
+  setup();
+
+  Sender sender(&Serial, &station, &robotArm);
+  if (!sender.handshake())
+  {
+    fprintf(stderr, "No receive buffer size advertised.\n");
+    return 1;
+  }
+  sender.binary = binary;
+
+  if (binary)
+  {
+    // Encoding needs the parked position, so it waits for setup.
+    std::deque<std::string> frames;
+    FrameEncoder encoder(&frames);
+    Parser<> reader(&encoder);
+    for (size_t i = 0; i < lines.size(); i++)
+    {
+      std::string line = lines[i].substr(0, lines[i].size() - 1);
+      int status = reader.parseLine(line.c_str());
+      if (status != STATUS_OK)
+      {
+        fprintf(stderr, "line %d: error:%d\n", (int)i + 1, status);
+      }
+    }
+    encoder.add(FRAME_END, NULL);
+    frames.push_front("$B\n");
+    lines.swap(frames);
+  }
+#ifdef SECOND_ARM
+  // The second arm draws the same job.
+  Sender secondSender(&Serial1, &secondStation, &secondArm);
+  if (!secondSender.handshake())
+  {
+    fprintf(stderr, "No receive buffer size advertised on Serial1.\n");
+    return 1;
+  }
+  secondSender.binary = binary;
+  secondSender.lines = lines;
+#endif
+  if (stored)
+  {
+    lines.push_front("$U=JOB.NC\n");
+    lines.push_back("%\n");
+  }
+  sender.lines.swap(lines);
+
+  unsigned long start = micros();
+  bool uploading = stored;
+  PenCheck penCheck;
+  while (!sender.finished() || !arms.idle() || uploading || playing()
+#ifdef SECOND_ARM
+         || !secondSender.finished()
+#endif
+        )
+  {
+    if (uploading && sender.finished())
+    {
+      // The upload is stored, time the job run from the card.
+      fprintf(stderr, "uploaded %ld bytes in %.3f seconds\n", sender.sent, (micros() - start) / 1E6);
+      sender.lines.push_back("$R=JOB.NC\n");
+      uploading = false;
+      sender.sent = 0;
+      start = micros();
+    }
+
+    sender.send();
+#ifdef SECOND_ARM
+    secondSender.send();
+#endif
+
+    loop();
+
+    if (!sender.receive())
+    {
+      return 1;
+    }
+#ifdef SECOND_ARM
+    if (!secondSender.receive())
+    {
+      return 1;
+    }
+#endif
+
+    penCheck.sample();
+    simAdvance(SIM_LOOP_MICROS);
+    if (micros() - start > SIM_TIMEOUT_MICROS)
+    {
+      fprintf(stderr, "Timed out.\n");
+      return 1;
+    }
+  }
+
+  int lineNumber = sender.lineNumber;
+  int errors = sender.errors;
+  long sent = sender.sent;
+  SpeedCheck &speedCheck = sender.speedCheck;
+  fprintf(stderr, "%d %s, %ld bytes, %d errors, %.3f seconds\n", lineNumber, binary ? "frames" : "lines",
+    sent, errors, (micros() - start) / 1E6);
+  speedCheck.finish();
+  if (speedCheck.stretches > 0)
+  {
+    fprintf(stderr, "pen speed %.2f%% to %.2f%% of planned over %d stretches\n",
+      speedCheck.slowest * 100, speedCheck.fastest * 100, speedCheck.stretches);
+  }
+  if (penCheck.transitions > 0)
+  {
+    fprintf(stderr, "%d pen transitions, %d steps with the pen off the paper but not clear\n",
+      penCheck.transitions, penCheck.dragged);
+  }
+#ifdef PULSE_ENGINE
+  fprintf(stderr, "%lu frames\n", pulses.frames());
+  simReportPins(stderr);
+#else
+#ifdef POLAR_PLOTTER
+  reportServo("turn", turnServo);
+  reportServo("slide", slideServo);
+#else
+  reportServo("shoulder", shoulderServo);
+  reportServo("elbow", elbowServo);
+  reportServo("pen", penServo);
+#ifdef SECOND_ARM
+  reportServo("second shoulder", secondShoulderServo);
+  reportServo("second elbow", secondElbowServo);
+  reportServo("second pen", secondPenServo);
+#endif
+#endif
+#endif
+#ifdef SECOND_ARM
+  fprintf(stderr, "second arm: %d lines, %d errors\n", secondSender.lineNumber, secondSender.errors);
+  errors += secondSender.errors;
+  secondSender.speedCheck.finish();
+  if (secondSender.speedCheck.stretches > 0)
+  {
+    fprintf(stderr, "second arm pen speed %.2f%% to %.2f%% of planned over %d stretches\n",
+      secondSender.speedCheck.slowest * 100, secondSender.speedCheck.fastest * 100,
+      secondSender.speedCheck.stretches);
+  }
+  fprintf(stderr, "%s\n%s\n", sender.status().c_str(), secondSender.status().c_str());
+#endif
+  if (Serial.overruns > 0)
+  {
+    fprintf(stderr, "%lu bytes lost to receive overruns\n", Serial.overruns);
+  }
+
+  if (simTrace != NULL)
+  {
+    fclose(simTrace);
+  }
+#ifdef JOB_STORAGE
+  if (stored)
+  {
+    SD.remove("JOB.NC");
+    rmdir(card);
+  }
+#endif
+  return errors > 0 || penCheck.dragged > 0 ? 2 : 0;
+}
+
+/*
+┌──────────────────────────────────────────────────────────────────────────┐
+│                                                   TERMS OF USE: MIT License                                                   │
+├──────────────────────────────────────────────────────────────────────────┤
+│Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation     │
+│files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,     │
+│modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software │
+│is furnished to do so, subject to the following conditions:                                                                    │
+│                                                                                                                               │
+│The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. │
+│                                                                                                                               │
+│THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE           │
+│WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR          │
+│COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,    │
+│ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                          │
+└──────────────────────────────────────────────────────────────────────────┘
+*/
+
@@ -0,0 +1,15 @@
+(Square with a circle inside, for the simulator.)
+G21 G90
+G0 X-30 Y90
+G1 Z-1
+G1 X30 Y90 F3000
+G1 X30 Y150
+G1 X-30 Y150
+G1 X-30 Y90
+G0 Z5
+G0 X0 Y95
+M10
+G2 X0 Y95 I0 J25
+M11
+G4 P0.5
+G28
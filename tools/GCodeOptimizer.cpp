@@ -0,0 +1,902 @@
+//------------------------------------------------------------------------------
+// GCodeOptimizer - host program which rewrites a job before it is streamed to
+// the arm. The job is read with the firmware's own Parser, so arcs come out
+// exactly as the arm would follow them, and what the arm refuses, such as
+// inches or relative moves, is reported as an error here too.
+//
+// Usage:
+//   gcode_optimizer [-t tolerance] job.gcode optimized.gcode
+//
+// Strokes, the runs of G1 moves between G0 travels, are reordered to shorten
+// the travel between them. They are chained nearest neighbour first, then
+// improved with 2-opt, and either end of a stroke may be drawn first. A stroke
+// drawn backwards keeps its pen moves, the G1 moves of Z alone at either end,
+// where they were, so the pen still goes down and up at the ends. Runs of
+// G1 moves at the same feed are merged into one while the points dropped stay
+// within the tolerance in mm (default 0.02) of the merged line.
+//
+// Dwells, vacuum, homing and parking stay in place, and strokes are only
+// reordered between them. When travels lift Z, the reordered travels lift to
+// the highest Z the original travels used, but only from below the lowest Z
+// they moved at. Arcs in the XY plane are written back as G2 and G3, found by
+// fitting a circle to the segments the parser divides them into.
+//
+// Both jobs are then timed. Drawing time comes from the firmware's planner and
+// executor on the virtual clock. G0 moves are not timed by the firmware, so
+// the time the joints need to slew for them at their velocity limits is
+// added, found from the ScaraArm kinematics. The comparison goes to stderr.
+//------------------------------------------------------------------------------
+// Copyright at end of file.
+
+// The standard headers come first, before the core's min and max macros.
+#include <algorithm>
+#include <vector>
+#include "../DrawbotMkII.ino"
+
+// Default largest distance in mm of a dropped point from the merged line.
+#define MERGE_TOLERANCE 0.02
+
+// Decimal places written for coordinates, a micron.
+#define OUTPUT_DECIMALS 3
+
+// 2-opt passes are stopped here even if the tour is still improving.
+#define MAX_2OPT_PASSES 100
+
+struct Point
+{
+  float x;
+  float y;
+  float z;
+};
+
+// One move, with the feed rate in effect or -1 when none was given. Arcs
+// also have their center and direction.
+struct Segment
+{
+  Point to;
+  float feed;
+  bool arc;
+  bool clockwise;
+  float centerX;
+  float centerY;
+};
+
+// A run of G1 moves drawn without a travel between them.
+struct Stroke
+{
+  Point start;
+  std::vector<Segment> segments;
+};
+
+/**
+ * travelDistance - length of a travel in the XY plane.
+ */
+float travelDistance(const Point &a, const Point &b)
+{
+  return hypot(b.x - a.x, b.y - a.y);
+}
+
+/**
+ * slewSeconds - time for the joints to carry the pen between two points when
+ * running at their velocity limits, as they do for a G0.
+ */
+float slewSeconds(const Point &a, const Point &b)
+{
+  float start[NUM_AXES] = { a.x, a.y, a.z, 0, 0, 0 };
+  float target[NUM_AXES] = { b.x, b.y, b.z, 0, 0, 0 };
+  float length = travelDistance(a, b);
+  if (length == 0)
+  {
+    return 0;
+  }
+
+  // Joints without limits slew as fast as the arm moves at all.
+  float speed = 1E6;
+  float acceleration = 1E6;
+  robotArm.limitMove(start, target, &speed, &acceleration);
+  return length / speed;
+}
+
+/**
+ * distanceToSegment - distance of a point from the straight move a to b.
+ */
+float distanceToSegment(const Point &p, const Point &a, const Point &b)
+{
+  float dx = b.x - a.x, dy = b.y - a.y, dz = b.z - a.z;
+  float lengthSq = dx * dx + dy * dy + dz * dz;
+  float t = 0;
+  if (lengthSq > 0)
+  {
+    t = constrain(((p.x - a.x) * dx + (p.y - a.y) * dy + (p.z - a.z) * dz) / lengthSq, 0.0f, 1.0f);
+  }
+  return sqrt(sq(p.x - a.x - t * dx) + sq(p.y - a.y - t * dy) + sq(p.z - a.z - t * dz));
+}
+
+/**
+ * fitArc - finds the circle in the XY plane through the points of an arc.
+ * The parser rotates most points incrementally, which drifts, but computes
+ * the ends and every ARC_CORRECTION-th point exactly, so the center is found
+ * from those when there are enough.
+ * @param points - the arc's start, then the end of each of its segments.
+ * @param segment - receives the center and direction.
+ * @return false if the points do not lie on a circle within the tolerance.
+ */
+bool fitArc(const std::vector<Point> &points, float tolerance, Segment *segment)
+{
+  int count = points.size() - 1;
+  const Point &a = points[0];
+  const Point &e = points[count];
+  double x, y;
+  double mx = (a.x + e.x) / 2.0, my = (a.y + e.y) / 2.0;
+  double nx = a.y - e.y, ny = e.x - a.x;
+  bool full = hypot(nx, ny) < 1E-3;
+
+  // The points between the ends which place the center.
+  std::vector<int> between;
+  for (int i = ARC_CORRECTION; i < count; i += ARC_CORRECTION)
+  {
+    between.push_back(i);
+  }
+  if (between.size() < (full ? 2U : 1U))
+  {
+    between.clear();
+    for (int i = 1; i < count; i++)
+    {
+      between.push_back(i);
+    }
+  }
+
+  if (full)
+  {
+    // A full circle, through three of its points.
+    const Point &b = points[between[between.size() / 3]];
+    const Point &c = points[between[2 * between.size() / 3]];
+    double d = 2.0 * (a.x * (b.y - c.y) + b.x * (c.y - a.y) + c.x * (a.y - b.y));
+    if (fabs(d) < 1E-6)
+    {
+      return false;
+    }
+    double aa = (double)a.x * a.x + (double)a.y * a.y;
+    double bb = (double)b.x * b.x + (double)b.y * b.y;
+    double cc = (double)c.x * c.x + (double)c.y * c.y;
+    x = (aa * (b.y - c.y) + bb * (c.y - a.y) + cc * (a.y - b.y)) / d;
+    y = (aa * (c.x - b.x) + bb * (a.x - c.x) + cc * (b.x - a.x)) / d;
+  }
+  else
+  {
+    // The center is on the perpendicular bisector of the ends, so both are
+    // at the same radius as the firmware requires. Each point between
+    // places it along the bisector, and the places are averaged.
+    double sum = 0;
+    int used = 0;
+    for (size_t i = 0; i < between.size(); i++)
+    {
+      const Point &p = points[between[i]];
+      double d = 2.0 * (nx * (a.x - p.x) + ny * (a.y - p.y));
+      if (fabs(d) > 1E-6)
+      {
+        sum += (sq(mx - a.x) + sq(my - a.y) - sq(mx - p.x) - sq(my - p.y)) / d;
+        used++;
+      }
+    }
+    if (used == 0)
+    {
+      return false;
+    }
+    x = mx + nx * sum / used;
+    y = my + ny * sum / used;
+  }
+
+  double radius = hypot(a.x - x, a.y - y);
+  for (int i = 1; i <= count; i++)
+  {
+    if (fabs(hypot(points[i].x - x, points[i].y - y) - radius) > tolerance)
+    {
+      return false;
+    }
+  }
+
+  segment->arc = true;
+  segment->clockwise = (a.x - x) * (points[1].y - y) - (a.y - y) * (points[1].x - x) < 0;
+  segment->centerX = x;
+  segment->centerY = y;
+  return true;
+}
+
+// Records the moves the parser makes and writes them back out optimized. The
+// strokes are collected until a command which must stay in place, then the
+// collected group is reordered and written before the command.
+class JobOptimizer : public GCodeProcessor
+{
+  public:
+    /**
+     * @param out - the file the optimized job is written to.
+     * @param tolerance - largest distance in mm of a merged away point.
+     */
+    JobOptimizer(FILE *out, float tolerance)
+    {
+      _out = out;
+      _tolerance = tolerance;
+      _feed = -1;
+      _writtenFeed = -1;
+      _traveled = false;
+      _anchored = false;
+      _sourceStrokes = 0;
+      _sourceSegments = 0;
+      inputTravel = 0;
+      outputTravel = 0;
+      inputSlew = 0;
+      outputSlew = 0;
+      inputMoves = 0;
+      outputMoves = 0;
+
+      // The arm parks when it starts.
+      robotArm.park();
+      _position.x = robotArm.getX();
+      _position.y = robotArm.getY();
+      _position.z = 0;
+      _written = _position;
+      _groupStart = _position;
+      _safeZ = _position.z;
+      _travelZ = INFINITY;
+      fprintf(_out, "G21 G90\n");
+    }
+
+    void park()
+    {
+      flush();
+      fprintf(_out, "G28\n");
+      robotArm.park();
+      _position.x = robotArm.getX();
+      _position.y = robotArm.getY();
+      startGroup();
+    }
+
+    float getX() { return _position.x; }
+    float getY() { return _position.y; }
+    float getZ() { return _position.z; }
+    float getA() { return 0; }
+    float getB() { return 0; }
+    float getC() { return 0; }
+
+    void setFeedrate(float f)
+    {
+      if (f > 0)
+      {
+        _feed = f;
+      }
+    }
+
+    void setHome(float x, float y, float z, float a, float b, float c)
+    {
+      flush();
+      fprintf(_out, "M206 X%s Y%s Z%s\n", format(x), format(y), format(z));
+      startGroup();
+    }
+
+    void setPosition(float x, float y, float z, float a, float b, float c)
+    {
+      Point target = { x, y, z };
+      inputTravel += travelDistance(_position, target);
+      inputSlew += slewSeconds(_position, target);
+      _safeZ = max(_safeZ, max(_position.z, z));
+      if (travelDistance(_position, target) > 0)
+      {
+        _travelZ = min(_travelZ, z);
+      }
+      _position = target;
+      _traveled = true;
+    }
+
+    void movePosition(float x, float y, float z, float a, float b, float c)
+    {
+      if (_traveled || _strokes.empty())
+      {
+        // A stroke drawn on from where the group started stays first.
+        _anchored = _anchored || (_strokes.empty() && !_traveled);
+        _strokes.push_back(Stroke());
+        _strokes.back().start = _position;
+      }
+      Segment segment = { { x, y, z }, _feed, false, false, 0, 0 };
+      _strokes.back().segments.push_back(segment);
+      _position = segment.to;
+      _traveled = false;
+      inputMoves++;
+    }
+
+    void enableVacuum(boolean enable)
+    {
+      flush();
+      fprintf(_out, enable ? "M10\n" : "M11\n");
+      startGroup();
+    }
+
+    void dwell(float seconds)
+    {
+      flush();
+      fprintf(_out, "G4 P%s\n", format(seconds));
+      startGroup();
+    }
+
+    /**
+     * beginSource - called before each input line is parsed, so the moves of
+     * an arc can be told from separate lines.
+     */
+    void beginSource()
+    {
+      _sourceStrokes = _strokes.size();
+      _sourceSegments = _strokes.empty() ? 0 : _strokes.back().segments.size();
+    }
+
+    /**
+     * endSource - called after each input line is parsed. A line which made
+     * several moves was an arc, and they are replaced by one arc move.
+     */
+    void endSource()
+    {
+      if (_strokes.empty())
+      {
+        return;
+      }
+      Stroke &stroke = _strokes.back();
+      int first = _strokes.size() > _sourceStrokes ? 0 : _sourceSegments;
+      int count = stroke.segments.size() - first;
+      if (count < 3)
+      {
+        return;
+      }
+
+      std::vector<Point> points;
+      points.push_back(first == 0 ? stroke.start : stroke.segments[first - 1].to);
+      for (int i = first; i < (int)stroke.segments.size(); i++)
+      {
+        points.push_back(stroke.segments[i].to);
+      }
+      Segment arc = stroke.segments.back();
+      if (fitArc(points, _tolerance, &arc))
+      {
+        stroke.segments.resize(first);
+        stroke.segments.push_back(arc);
+        inputMoves -= count - 1;
+      }
+    }
+
+    /**
+     * flush - reorders the strokes collected since the last command and
+     * writes them, ending at the position the input ended the group at.
+     */
+    void flush()
+    {
+      std::vector<int> order;
+      std::vector<bool> flipped;
+      planTour(&order, &flipped);
+      for (size_t i = 0; i < order.size(); i++)
+      {
+        writeStroke(_strokes[order[i]], flipped[i]);
+      }
+      if (_traveled)
+      {
+        writeTravel(_position, true);
+      }
+      _strokes.clear();
+    }
+
+    float inputTravel;
+    float outputTravel;
+    float inputSlew;
+    float outputSlew;
+    long inputMoves;
+    long outputMoves;
+
+  private:
+    FILE *_out;
+    float _tolerance;
+    float _feed;
+    float _writtenFeed;
+
+    // Where the parser has moved to, and where the output has moved to.
+    Point _position;
+    Point _written;
+
+    // The group of strokes being collected.
+    std::vector<Stroke> _strokes;
+    Point _groupStart;
+    float _safeZ;
+    float _travelZ;
+    boolean _traveled;
+    boolean _anchored;
+
+    // Size of the strokes when the current input line began.
+    size_t _sourceStrokes;
+    int _sourceSegments;
+
+    void startGroup()
+    {
+      _groupStart = _position;
+      _safeZ = _position.z;
+      _travelZ = INFINITY;
+      _traveled = false;
+      _anchored = false;
+    }
+
+    /**
+     * penMoves - counts the pen moves, the moves of Z alone, at each end of
+     * a stroke's moves.
+     * @param lead - receives the number at the start.
+     * @param tail - receives the index of the first one at the end.
+     */
+    static void penMoves(const Point &start, const std::vector<Segment> &moves, int *lead, int *tail)
+    {
+      int count = moves.size();
+      *lead = 0;
+      while (*lead < count && travelDistance(start, moves[*lead].to) == 0)
+      {
+        (*lead)++;
+      }
+      *tail = count;
+      while (*tail > *lead + 1 && travelDistance(moves[*tail - 2].to, moves[*tail - 1].to) == 0)
+      {
+        (*tail)--;
+      }
+    }
+
+    /**
+     * reversible - whether a stroke may be drawn backwards, which needs the
+     * moves between its pen moves to begin and end at the same height.
+     */
+    bool reversible(int stroke)
+    {
+      const Stroke &s = _strokes[stroke];
+      int lead, tail;
+      penMoves(s.start, s.segments, &lead, &tail);
+      const Point &from = lead > 0 ? s.segments[lead - 1].to : s.start;
+      return lead == tail || from.z == s.segments[tail - 1].to.z;
+    }
+
+    /**
+     * reverseStroke - turns a stroke's moves around. The pen moves at each
+     * end keep their place and heights, and the moves between run backwards
+     * from where the last one ended.
+     */
+    static void reverseStroke(Point *start, std::vector<Segment> *moves)
+    {
+      std::vector<Segment> &m = *moves;
+      int lead, tail;
+      penMoves(*start, m, &lead, &tail);
+      Point from = lead > 0 ? m[lead - 1].to : *start;
+      Point to = tail > lead ? m[tail - 1].to : from;
+
+      // Each move between runs back to where the one before it started.
+      for (int k = tail - 1; k > lead; k--)
+      {
+        m[k].to = m[k - 1].to;
+      }
+      if (tail > lead)
+      {
+        m[lead].to = from;
+      }
+      std::reverse(m.begin() + lead, m.begin() + tail);
+      for (int k = lead; k < tail; k++)
+      {
+        m[k].clockwise = !m[k].clockwise;
+      }
+
+      // The pen moves trade places in XY only.
+      start->x = to.x;
+      start->y = to.y;
+      for (int k = 0; k < lead; k++)
+      {
+        m[k].to.x = to.x;
+        m[k].to.y = to.y;
+      }
+      for (int k = tail; k < (int)m.size(); k++)
+      {
+        m[k].to.x = from.x;
+        m[k].to.y = from.y;
+      }
+    }
+
+    const Point &strokeStart(int stroke, bool flip)
+    {
+      const Stroke &s = _strokes[stroke];
+      return flip ? s.segments.back().to : s.start;
+    }
+
+    const Point &strokeEnd(int stroke, bool flip)
+    {
+      const Stroke &s = _strokes[stroke];
+      return flip ? s.start : s.segments.back().to;
+    }
+
+    /**
+     * planTour - orders the strokes nearest neighbour first, then applies
+     * 2-opt moves, which reverse a run of the tour, while they shorten it.
+     * An anchored first stroke keeps its place and direction, a stroke which
+     * is not reversible keeps its direction, and a travel ending the group
+     * is kept as the tour's fixed end.
+     */
+    void planTour(std::vector<int> *order, std::vector<bool> *flipped)
+    {
+      int count = _strokes.size();
+      std::vector<bool> used(count, false);
+      std::vector<bool> fixed(count);
+      for (int i = 0; i < count; i++)
+      {
+        fixed[i] = !reversible(i);
+      }
+      Point at = _groupStart;
+      for (int n = 0; n < count; n++)
+      {
+        int best = 0;
+        bool bestFlip = false;
+        float bestDistance = INFINITY;
+        for (int i = 0; i < count; i++)
+        {
+          if (used[i] || (_anchored && n == 0 && i != 0))
+          {
+            continue;
+          }
+          for (int f = 0; f < 2; f++)
+          {
+            float distance = travelDistance(at, strokeStart(i, f));
+            if (distance < bestDistance && !(f && (fixed[i] || (_anchored && i == 0))))
+            {
+              best = i;
+              bestFlip = f;
+              bestDistance = distance;
+            }
+          }
+        }
+        used[best] = true;
+        order->push_back(best);
+        flipped->push_back(bestFlip);
+        at = strokeEnd(best, bestFlip);
+      }
+
+      int first = _anchored ? 1 : 0;
+      for (int pass = 0; pass < MAX_2OPT_PASSES; pass++)
+      {
+        bool improved = false;
+        for (int i = first; i < count; i++)
+        {
+          const Point &before = i == 0 ? _groupStart : strokeEnd((*order)[i - 1], (*flipped)[i - 1]);
+          for (int j = i; j < count && !fixed[(*order)[j]]; j++)
+          {
+            const Point &startI = strokeStart((*order)[i], (*flipped)[i]);
+            const Point &endJ = strokeEnd((*order)[j], (*flipped)[j]);
+            float change = travelDistance(before, endJ) - travelDistance(before, startI);
+            if (j + 1 < count || _traveled)
+            {
+              const Point &after = j + 1 < count ? strokeStart((*order)[j + 1], (*flipped)[j + 1]) : _position;
+              change += travelDistance(startI, after) - travelDistance(endJ, after);
+            }
+
+            if (change < -0.001)
+            {
+              std::reverse(order->begin() + i, order->begin() + j + 1);
+              std::reverse(flipped->begin() + i, flipped->begin() + j + 1);
+              for (int k = i; k <= j; k++)
+              {
+                (*flipped)[k] = !(*flipped)[k];
+              }
+              improved = true;
+            }
+          }
+        }
+        if (!improved)
+        {
+          break;
+        }
+      }
+    }
+
+    /**
+     * writeTravel - writes the G0 moves to a point. When the pen is lower
+     * than the input ever traveled at, it is lifted to the group's highest
+     * travel Z first, and comes down at the point.
+     * @param descend - false to stay at the travel's height, when the stroke
+     * which follows begins with a pen move.
+     */
+    void writeTravel(const Point &to, bool descend)
+    {
+      float distance = travelDistance(_written, to);
+      if (distance == 0 && (_written.z == to.z || !descend))
+      {
+        return;
+      }
+
+      outputTravel += distance;
+      outputSlew += slewSeconds(_written, to);
+      bool lift = distance > 0 && _written.z < _travelZ && _safeZ > _written.z;
+      if (lift)
+      {
+        writeMove("G0", _written.x, _written.y, _safeZ, "");
+      }
+      if (lift || !descend)
+      {
+        writeMove("G0", to.x, to.y, _written.z, "");
+      }
+      if (descend)
+      {
+        writeMove("G0", to.x, to.y, to.z, "");
+      }
+    }
+
+    /**
+     * writeStroke - writes a stroke's moves, merging runs of G1 moves at the
+     * same feed which stay within the tolerance of a straight line.
+     */
+    void writeStroke(const Stroke &stroke, bool flip)
+    {
+      std::vector<Segment> moves = stroke.segments;
+      Point start = stroke.start;
+      int count = moves.size();
+      if (flip)
+      {
+        reverseStroke(&start, &moves);
+      }
+
+      // A stroke beginning with a pen move takes the pen down from wherever
+      // the travel left it.
+      int lead, tail;
+      penMoves(start, moves, &lead, &tail);
+      writeTravel(start, lead == 0);
+      Point from = _written;
+      int anchor = 0;
+      for (int k = 1; k < count; k++)
+      {
+        bool fits = !moves[anchor].arc && !moves[k].arc && moves[k].feed == moves[anchor].feed;
+        for (int m = anchor; fits && m < k; m++)
+        {
+          fits = distanceToSegment(moves[m].to, from, moves[k].to) <= _tolerance;
+        }
+        if (!fits)
+        {
+          writeLine(moves[k - 1]);
+          from = moves[k - 1].to;
+          anchor = k;
+        }
+      }
+      writeLine(moves[count - 1]);
+    }
+
+    void writeLine(const Segment &move)
+    {
+      if (move.feed > 0 && move.feed != _writtenFeed)
+      {
+        fprintf(_out, "F%s\n", format(move.feed));
+        _writtenFeed = move.feed;
+      }
+      if (move.arc)
+      {
+        // Center offsets are from the start, and the end is always given so
+        // a full circle is not mistaken for no move.
+        std::string offsets = std::string(" I") + format(move.centerX - _written.x)
+          + " J" + format(move.centerY - _written.y);
+        _written.x = NAN;
+        _written.y = NAN;
+        writeMove(move.clockwise ? "G2" : "G3", move.to.x, move.to.y, move.to.z, offsets.c_str());
+      }
+      else
+      {
+        writeMove("G1", move.to.x, move.to.y, move.to.z, "");
+      }
+      outputMoves++;
+    }
+
+    /**
+     * writeMove - writes a move giving only the axes which change, followed
+     * by any other words of the move.
+     */
+    void writeMove(const char *command, float x, float y, float z, const char *suffix)
+    {
+      std::string line = command;
+      const char *letters = "XYZ";
+      float values[3] = { x, y, z };
+      float *written[3] = { &_written.x, &_written.y, &_written.z };
+      for (int i = 0; i < 3; i++)
+      {
+        std::string value = format(values[i]);
+        if (value != format(*written[i]))
+        {
+          line = line + " " + letters[i] + value;
+        }
+        *written[i] = values[i];
+      }
+      if (line.size() > strlen(command))
+      {
+        fprintf(_out, "%s%s\n", line.c_str(), suffix);
+      }
+    }
+
+    /**
+     * format - writes a number with OUTPUT_DECIMALS places, less any trailing
+     * zeros. The text is valid until the fourth call after.
+     */
+    const char *format(float value)
+    {
+      static char text[4][24];
+      static int next = 0;
+      char *s = text[next];
+      next = (next + 1) % 4;
+      snprintf(s, sizeof(text[0]), "%.*f", OUTPUT_DECIMALS, value);
+      char *end = s + strlen(s) - 1;
+      while (*end == '0')
+      {
+        *end-- = 0;
+      }
+      if (*end == '.')
+      {
+        *end = 0;
+      }
+      if (strcmp(s, "-0") == 0)
+      {
+        strcpy(s, "0");
+      }
+      return s;
+    }
+};
+
+/**
+ * readLines - reads a job, dropping line ends.
+ * @return false if the file could not be read.
+ */
+bool readLines(const char *name, std::vector<std::string> *lines)
+{
+  FILE *file = fopen(name, "r");
+  if (file == NULL)
+  {
+    perror(name);
+    return false;
+  }
+  char text[256];
+  while (fgets(text, sizeof(text), file) != NULL)
+  {
+    text[strcspn(text, "\r\n")] = 0;
+    lines->push_back(text);
+  }
+  fclose(file);
+  return true;
+}
+
+/**
+ * stepMachine - runs the executor for a millisecond of virtual time.
+ */
+void stepMachine()
+{
+  executor.run();
+  simAdvance(1000);
+}
+
+/**
+ * drawingSeconds - runs a job through the firmware's parser, planner and
+ * executor, without the serial link, starting from the parked arm.
+ * @return the virtual seconds until the arm stops.
+ */
+float drawingSeconds(const std::vector<std::string> &lines)
+{
+  planner.park();
+  unsigned long start = micros();
+  for (size_t i = 0; i < lines.size(); i++)
+  {
+    while (!planner.ready())
+    {
+      stepMachine();
+    }
+    parser.parseLine(lines[i].c_str());
+
+    // An arc which did not fit in the queue is finished by listen.
+    while (parser.isBusy())
+    {
+      stepMachine();
+      parser.listen();
+    }
+  }
+  while (!planner.idle() || !executor.isIdle())
+  {
+    stepMachine();
+  }
+  return (micros() - start) / 1E6;
+}
+
+/**
+ * countBytes - the bytes a sender streams for a job, with line ends.
+ */
+long countBytes(const std::vector<std::string> &lines)
+{
+  long bytes = 0;
+  for (size_t i = 0; i < lines.size(); i++)
+  {
+    bytes += lines[i].size() + 1;
+  }
+  return bytes;
+}
+
+int main(int argc, char **argv)
+{
+  float tolerance = MERGE_TOLERANCE;
+  int arg = 1;
+  if (argc > 2 && strcmp(argv[1], "-t") == 0)
+  {
+    tolerance = atof(argv[2]);
+    arg = 3;
+  }
+  if (argc - arg != 2)
+  {
+    fprintf(stderr, "usage: %s [-t tolerance] job.gcode optimized.gcode\n", argv[0]);
+    return 1;
+  }
+
+  std::vector<std::string> input;
+  if (!readLines(argv[arg], &input))
+  {
+    return 1;
+  }
+  FILE *out = fopen(argv[arg + 1], "w");
+  if (out == NULL)
+  {
+    perror(argv[arg + 1]);
+    return 1;
+  }
+
+  // The firmware is set up as on the arm, for its joint limits and to time
+  // the jobs.
+  setup();
+
+  JobOptimizer optimizer(out, tolerance);
+  Parser<> reader(&optimizer);
+  int errors = 0;
+  for (size_t i = 0; i < input.size(); i++)
+  {
+    optimizer.beginSource();
+    int status = reader.parseLine(input[i].c_str());
+    optimizer.endSource();
+    if (status != STATUS_OK)
+    {
+      fprintf(stderr, "line %d: error:%d\n", (int)i + 1, status);
+      errors++;
+    }
+  }
+  optimizer.flush();
+  fclose(out);
+
+  std::vector<std::string> output;
+  if (!readLines(argv[arg + 1], &output))
+  {
+    return 1;
+  }
+  float inputDrawing = drawingSeconds(input);
+  float outputDrawing = drawingSeconds(output);
+  float inputTotal = inputDrawing + optimizer.inputSlew;
+  float outputTotal = outputDrawing + optimizer.outputSlew;
+
+  fprintf(stderr, "              lines    bytes    moves  travel mm  seconds\n");
+  fprintf(stderr, "input     %9d %8ld %8ld %10.1f %8.3f\n", (int)input.size(), countBytes(input),
+    optimizer.inputMoves, optimizer.inputTravel, inputTotal);
+  fprintf(stderr, "optimized %9d %8ld %8ld %10.1f %8.3f\n", (int)output.size(), countBytes(output),
+    optimizer.outputMoves, optimizer.outputTravel, outputTotal);
+  fprintf(stderr, "estimated %.3f seconds saved (%.1f%%)\n", inputTotal - outputTotal,
+    inputTotal > 0 ? 100 * (inputTotal - outputTotal) / inputTotal : 0.0);
+  return errors > 0 ? 2 : 0;
+}
+
+//------------------------------------------------------------------------------
+// Copyright (C) 2015 Martin Heermance (mheermance@gmail.com)
+/*
+┌──────────────────────────────────────────────────────────────────────────┐
+│                                                   TERMS OF USE: MIT License                                                   │
+├──────────────────────────────────────────────────────────────────────────┤
+│Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation     │
+│files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,     │
+│modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software │
+│is furnished to do so, subject to the following conditions:                                                                    │
+│                                                                                                                               │
+│The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. │
+│                                                                                                                               │
+│THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE           │
+│WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR          │
+│COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,    │
+│ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                          │
+└──────────────────────────────────────────────────────────────────────────┘
+*/
+
@@ -0,0 +1,254 @@
+//------------------------------------------------------------------------------
+// IKTableGenerator - host program which writes IKTable.h, the precomputed
+// inverse kinematics grid used when IK_LOOKUP_TABLE is defined in ScaraArm.h.
+//
+// Build and run on the host:
+//   g++ -O2 -o IKTableGenerator tools/IKTableGenerator.cpp
+//   ./IKTableGenerator 103 100 3 0.002 > IKTable.h
+//
+// Arguments are the humerus and ulna lengths in mm, the grid spacing as a
+// power of two in mm, and the largest interpolation error allowed in radians.
+//
+// Each cell of the grid is classified. Cells wholly out of reach reject points
+// without any math. Cells whose corners are reachable and interpolate within
+// the tolerance answer with a bilinear lookup. The rest, near the pillar and
+// at full reach where the angles change too quickly, fall back to solving the
+// kinematics. The share of each is reported on stderr so the spacing can be
+// traded against flash space.
+//------------------------------------------------------------------------------
+// Copyright at end of file.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+// Angles are stored as radians scaled by 2^13, which spans +/- PI in 16 bits.
+#define ANGLE_SCALE 8192.0
+
+// Cell classes, matching ScaraArm.h.
+#define IK_CELL_UNREACHABLE 0
+#define IK_CELL_SOLVE 1
+#define IK_CELL_INTERPOLATE 2
+
+struct Arm
+{
+  double humerus;
+  double ulna;
+
+  /**
+   * solve : the same inverse kinematics as ScaraArm::setPosition, returning the
+   * shoulder angle and the elbow angle as passed to the Joint.
+   * @return false if the point is out of reach.
+   */
+  bool solve(double x, double y, double *shoulder, double *elbow) const
+  {
+    double s_w = x * x + y * y;
+    double s_w_sqrt = sqrt(s_w);
+    if (s_w_sqrt == 0)
+    {
+      return false;
+    }
+
+    double q = (humerus * humerus - ulna * ulna + s_w) / (2.0 * humerus * s_w_sqrt);
+    double e = (humerus * humerus + ulna * ulna - s_w) / (2.0 * humerus * ulna);
+    if (q > 1 || q < -1 || e > 1 || e < -1)
+    {
+      return false;
+    }
+
+    *shoulder = atan2(y, x) - acos(q);
+
+    // Elbow is rotated to the right arm solution, then by a straight angle
+    // as in ScaraArm::setElbow.
+    *elbow = (2 * M_PI - acos(e)) - M_PI;
+    return true;
+  }
+};
+
+/**
+ * classify : decides whether a cell is wholly out of reach by comparing the
+ * nearest and furthest points of the cell with the reach of the arm.
+ * @return IK_CELL_UNREACHABLE, or IK_CELL_INTERPOLATE if it may be reachable.
+ */
+int classify(double x, double y, double spacing, double innerReach, double outerReach)
+{
+  double nearX = fmax(x, fmin(0.0, x + spacing));
+  double nearY = fmax(y, fmin(0.0, y + spacing));
+  double farX = fmax(fabs(x), fabs(x + spacing));
+  double farY = fmax(fabs(y), fabs(y + spacing));
+  if (hypot(nearX, nearY) > outerReach || hypot(farX, farY) < innerReach)
+  {
+    return IK_CELL_UNREACHABLE;
+  }
+  return IK_CELL_INTERPOLATE;
+}
+
+/**
+ * cellError : samples a cell to find the worst difference between bilinear
+ * interpolation of its corners and the exact solution.
+ * @param shoulder - the cell's first corner in the shoulder table.
+ * @param elbow - the cell's first corner in the elbow table.
+ * @param columns - row stride of the tables.
+ */
+double cellError(const Arm &arm, const int *shoulder, const int *elbow, int columns, double x, double y, double spacing)
+{
+  const int *tables[] = { shoulder, elbow };
+  double worst = 0;
+  for (int sy = 0; sy <= 8; sy++)
+  {
+    for (int sx = 0; sx <= 8; sx++)
+    {
+      double fx = sx / 8.0, fy = sy / 8.0;
+      double exact[2];
+      if (!arm.solve(x + fx * spacing, y + fy * spacing, &exact[0], &exact[1]))
+      {
+        // Reachable corners around an unreachable point means the cell
+        // straddles the pillar, which cannot be interpolated.
+        return INFINITY;
+      }
+      for (int t = 0; t < 2; t++)
+      {
+        const int *v = tables[t];
+        double value = ((v[0] * (1 - fx) + v[1] * fx) * (1 - fy)
+          + (v[columns] * (1 - fx) + v[columns + 1] * fx) * fy) / ANGLE_SCALE;
+        worst = fmax(worst, fabs(value - exact[t]));
+      }
+    }
+  }
+  return worst;
+}
+
+int main(int argc, char **argv)
+{
+  if (argc != 5)
+  {
+    fprintf(stderr, "usage: %s humerus ulna spacingBits tolerance\n", argv[0]);
+    return 1;
+  }
+
+  Arm arm = { atof(argv[1]), atof(argv[2]) };
+  int spacingBits = atoi(argv[3]);
+  int spacing = 1 << spacingBits;
+  double tolerance = atof(argv[4]);
+  double outerReach = arm.humerus + arm.ulna;
+  double innerReach = fabs(arm.humerus - arm.ulna);
+
+  // Cover the half disc in front of the pillar, rounded out to whole cells.
+  int reach = (int)ceil(arm.humerus + arm.ulna);
+  int cellsX = (2 * reach + spacing - 1) / spacing;
+  int cellsY = (reach + spacing - 1) / spacing;
+  int xMin = -(cellsX * spacing) / 2;
+  int columns = cellsX + 1;
+  int rows = cellsY + 1;
+
+  std::vector<int> shoulder(rows * columns), elbow(rows * columns);
+  std::vector<bool> reachable(rows * columns);
+  for (int j = 0; j < rows; j++)
+  {
+    for (int i = 0; i < columns; i++)
+    {
+      double s = 0, e = 0;
+      int n = j * columns + i;
+      reachable[n] = arm.solve(xMin + i * spacing, j * spacing, &s, &e);
+      shoulder[n] = (int)lround(s * ANGLE_SCALE);
+      elbow[n] = (int)lround(e * ANGLE_SCALE);
+    }
+  }
+
+  std::vector<unsigned char> mask((cellsX * cellsY + 3) / 4);
+  int counts[3] = { 0, 0, 0 };
+  double worst = 0;
+  for (int j = 0; j < cellsY; j++)
+  {
+    for (int i = 0; i < cellsX; i++)
+    {
+      int n = j * columns + i;
+      int kind = classify(xMin + i * spacing, j * spacing, spacing, innerReach, outerReach);
+      if (kind == IK_CELL_INTERPOLATE)
+      {
+        if (!reachable[n] || !reachable[n + 1] || !reachable[n + columns] || !reachable[n + columns + 1])
+        {
+          kind = IK_CELL_SOLVE;
+        }
+        else
+        {
+          double error = cellError(arm, &shoulder[n], &elbow[n], columns, xMin + i * spacing, j * spacing, spacing);
+          if (error > tolerance)
+          {
+            kind = IK_CELL_SOLVE;
+          }
+          else
+          {
+            worst = fmax(worst, error);
+          }
+        }
+      }
+
+      int cell = j * cellsX + i;
+      mask[cell / 4] |= kind << ((cell % 4) * 2);
+      counts[kind]++;
+    }
+  }
+  fprintf(stderr, "%d x %d grid, %d bytes of flash, worst error %.5f radians\n",
+    columns, rows, (int)(4 * rows * columns + mask.size()), worst);
+  fprintf(stderr, "%d cells unreachable, %d solved, %d interpolated\n",
+    counts[IK_CELL_UNREACHABLE], counts[IK_CELL_SOLVE], counts[IK_CELL_INTERPOLATE]);
+
+  printf("//------------------------------------------------------------------------------\n");
+  printf("// Inverse kinematics grid for a %g mm humerus and %g mm ulna, generated by\n", arm.humerus, arm.ulna);
+  printf("// tools/IKTableGenerator.cpp. Do not edit, regenerate it instead.\n");
+  printf("// Worst error of the interpolated cells is %.5f radians.\n", worst);
+  printf("//------------------------------------------------------------------------------\n\n");
+  printf("#ifndef IKTable_H\n#define IKTable_H\n\n");
+  printf("#define IK_TABLE_HUMERUS %g\n", arm.humerus);
+  printf("#define IK_TABLE_ULNA %g\n", arm.ulna);
+  printf("#define IK_TABLE_X_MIN %d\n", xMin);
+  printf("#define IK_TABLE_SPACING_BITS %d\n", spacingBits);
+  printf("#define IK_TABLE_COLUMNS %d\n", columns);
+  printf("#define IK_TABLE_ROWS %d\n", rows);
+  printf("#define IK_TABLE_ANGLE_SCALE %d\n", (int)ANGLE_SCALE);
+  printf("#define IK_TABLE_ERROR %.5f\n\n", worst);
+
+  const char *names[] = { "IK_SHOULDER_TABLE", "IK_ELBOW_TABLE" };
+  std::vector<int> *tables[] = { &shoulder, &elbow };
+  for (int t = 0; t < 2; t++)
+  {
+    printf("const int16_t %s[IK_TABLE_ROWS * IK_TABLE_COLUMNS] PROGMEM =\n{", names[t]);
+    for (int n = 0; n < rows * columns; n++)
+    {
+      printf("%s%d,", (n % 12) ? " " : "\n  ", (*tables[t])[n]);
+    }
+    printf("\n};\n\n");
+  }
+
+  printf("// Two bits per cell holding its IK_CELL class, four cells per byte.\n");
+  printf("const uint8_t IK_CELL_MASK[%d] PROGMEM =\n{", (int)mask.size());
+  for (size_t n = 0; n < mask.size(); n++)
+  {
+    printf("%s0x%02x,", (n % 12) ? " " : "\n  ", mask[n]);
+  }
+  printf("\n};\n\n#endif  // IKTable_H\n");
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Copyright (C) 2015 Martin Heermance (mheermance@gmail.com)
+/*
+┌──────────────────────────────────────────────────────────────────────────┐
+│                                                   TERMS OF USE: MIT License                                                   │
+├──────────────────────────────────────────────────────────────────────────┤
+│Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation     │
+│files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,     │
+│modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software │
+│is furnished to do so, subject to the following conditions:                                                                    │
+│                                                                                                                               │
+│The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. │
+│                                                                                                                               │
+│THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE           │
+│WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR          │
+│COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,    │
+│ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                          │
+└──────────────────────────────────────────────────────────────────────────┘
+*/
+